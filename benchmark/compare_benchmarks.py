@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+# Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+# All rights reserved.
+#
+# Software License Agreement (BSD License 2.0)
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above
+#    copyright notice, this list of conditions and the following
+#    disclaimer in the documentation and/or other materials provided
+#    with the distribution.
+#  * Neither the name of the Willow Garage nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+# CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+"""
+Store benchmark baselines and compare runs of control_toolbox_benchmark against them.
+
+Baselines are machine specific, one file per host in benchmark/baselines,
+named after the host and kept under version control with the code:
+
+  compare_benchmarks.py record --benchmark <control_toolbox_benchmark>
+  compare_benchmarks.py compare <baseline.json> <run.json>
+  compare_benchmarks.py check --benchmark <control_toolbox_benchmark>
+  compare_benchmarks.py host
+
+For every kernel and channel count, the samples of a run are compared
+with the baseline with a one sided Mann-Whitney U test, and the ratio of
+the medians gets a bootstrap confidence interval. A kernel regresses if
+it is significantly slower and the whole interval is above 1 + threshold,
+which keeps the noise of a busy machine from failing the check.
+
+`check` runs the benchmark and compares it with the baseline of this
+host. Without a baseline it fails with --require-baseline, and otherwise
+warns and exits with 77 (skipped). `host` prints the name of the baseline
+of this host.
+"""
+
+import argparse
+import datetime
+import json
+import math
+import os
+import platform
+import random
+import re
+import subprocess
+import sys
+import tempfile
+
+FORMAT_VERSION = 1
+SKIPPED = 77
+DEFAULT_BASELINES = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'baselines')
+
+
+def median(values):
+    ordered = sorted(values)
+    n = len(ordered)
+    return 0.5 * (ordered[(n - 1) // 2] + ordered[n // 2])
+
+
+def mann_whitney_greater(x, y):
+    """Return the p-value of the one sided test that x tends to be greater than y."""
+    n1, n2 = len(x), len(y)
+    pooled = sorted([(v, 0) for v in x] + [(v, 1) for v in y])
+
+    # Average ranks of ties, and the tie correction of the variance
+    ranks = [0.0] * len(pooled)
+    tie_term = 0.0
+    i = 0
+    while i < len(pooled):
+        j = i
+        while j + 1 < len(pooled) and pooled[j + 1][0] == pooled[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = 0.5 * (i + j) + 1.0
+        t = j - i + 1
+        tie_term += t ** 3 - t
+        i = j + 1
+
+    rank_sum = sum(r for r, (_, group) in zip(ranks, pooled) if group == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    n = n1 + n2
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0.0:
+        return 0.5
+    # Normal approximation with continuity correction
+    z = (u - n1 * n2 / 2.0 - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def bootstrap_ratio(x, y, confidence, resamples=2000, seed=0):
+    """Return a confidence interval of median(x) / median(y)."""
+    rng = random.Random(seed)
+    ratios = []
+    for _ in range(resamples):
+        mx = median([rng.choice(x) for _ in x])
+        my = median([rng.choice(y) for _ in y])
+        ratios.append(mx / my if my > 0.0 else float('inf'))
+    ratios.sort()
+    tail = (1.0 - confidence) / 2.0
+    low = ratios[int(math.floor(tail * (resamples - 1)))]
+    high = ratios[int(math.ceil((1.0 - tail) * (resamples - 1)))]
+    return low, high
+
+
+def host_name():
+    """Return a file name identifying the machine, as the baselines are machine specific."""
+    cpu = platform.processor() or platform.machine()
+    try:
+        with open('/proc/cpuinfo') as cpuinfo:
+            for line in cpuinfo:
+                if line.startswith('model name'):
+                    cpu = line.split(':', 1)[1].strip()
+                    break
+    except OSError:
+        pass
+    return re.sub(r'[^A-Za-z0-9]+', '_', platform.node() + '_' + cpu).strip('_')
+
+
+def git_revision():
+    try:
+        return subprocess.check_output(
+            ['git', 'describe', '--always', '--dirty'],
+            cwd=os.path.dirname(os.path.abspath(__file__)),
+            stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return 'unknown'
+
+
+def run_benchmark(benchmark, repetitions, kernel_filter):
+    with tempfile.TemporaryDirectory() as directory:
+        output = os.path.join(directory, 'run.json')
+        command = [benchmark, '--repetitions', str(repetitions), '--output', output]
+        if kernel_filter:
+            command += ['--filter', kernel_filter]
+        subprocess.check_call(command)
+        with open(output) as run:
+            return json.load(run)
+
+
+def load(path):
+    """Load a baseline or a raw benchmark run, keyed by (kernel, channels)."""
+    with open(path) as file:
+        data = json.load(file)
+    if data.get('format_version') != FORMAT_VERSION:
+        raise ValueError('%s has an unsupported format version' % path)
+    if 'benchmark' in data:
+        data = data['benchmark']
+    return {(r['kernel'], r['channels']): r['ns_per_call'] for r in data['results']}
+
+
+def compare(baseline, run, threshold, alpha, confidence):
+    """Print the comparison table and return the number of regressions."""
+    regressions = 0
+    print('%-36s %8s %10s %10s %8s %17s %9s' % (
+        'kernel', 'channels', 'base ns', 'new ns', 'change', 'ratio CI', 'p'))
+    for key in sorted(run):
+        if key not in baseline:
+            print('%-36s %8d %10s %10.2f   not in baseline' % (
+                key[0], key[1], '-', median(run[key])))
+            continue
+        base, new = baseline[key], run[key]
+        ratio = median(new) / median(base)
+        low, high = bootstrap_ratio(new, base, confidence)
+        p_slower = mann_whitney_greater(new, base)
+        p_faster = mann_whitney_greater(base, new)
+        status = ''
+        if p_slower < alpha and low > 1.0 + threshold:
+            status = 'REGRESSION'
+            regressions += 1
+        elif p_faster < alpha and high < 1.0 - threshold:
+            status = 'improvement'
+        print('%-36s %8d %10.2f %10.2f %+7.1f%% [%6.3f, %6.3f] %9.2g %s' % (
+            key[0], key[1], median(base), median(new), 100.0 * (ratio - 1.0), low, high,
+            min(p_slower, p_faster), status))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    def add_run_arguments(subparser):
+        subparser.add_argument('--benchmark', required=True,
+                               help='path of the control_toolbox_benchmark executable')
+        subparser.add_argument('--baselines', default=DEFAULT_BASELINES,
+                               help='directory of the baselines')
+        subparser.add_argument('--repetitions', type=int, default=15)
+        subparser.add_argument('--filter', default='', help='only run kernels matching this')
+
+    def add_test_arguments(subparser):
+        subparser.add_argument('--threshold', type=float, default=0.1,
+                               help='relative slowdown tolerated, default 10%%')
+        subparser.add_argument('--alpha', type=float, default=0.01,
+                               help='significance level of the U test')
+        subparser.add_argument('--confidence', type=float, default=0.95,
+                               help='level of the bootstrap interval')
+
+    record = subparsers.add_parser('record', help='run the benchmark and store the baseline')
+    add_run_arguments(record)
+
+    compare_parser = subparsers.add_parser('compare', help='compare two result files')
+    compare_parser.add_argument('baseline')
+    compare_parser.add_argument('run')
+    add_test_arguments(compare_parser)
+
+    check = subparsers.add_parser('check', help='run the benchmark and compare to the baseline')
+    add_run_arguments(check)
+    add_test_arguments(check)
+    check.add_argument('--require-baseline', action='store_true',
+                       help='fail instead of skipping if this host has no baseline')
+
+    subparsers.add_parser('host', help='print the name of the baseline of this host')
+
+    args = parser.parse_args()
+
+    if args.command == 'host':
+        print(host_name())
+        return 0
+
+    if args.command == 'compare':
+        regressions = compare(load(args.baseline), load(args.run), args.threshold, args.alpha,
+                              args.confidence)
+        return 1 if regressions else 0
+
+    path = os.path.join(args.baselines, host_name() + '.json')
+    if args.command == 'record':
+        baseline = {
+            'format_version': FORMAT_VERSION,
+            'host': host_name(),
+            'revision': git_revision(),
+            'created': datetime.datetime.now(datetime.timezone.utc).isoformat(),
+            'benchmark': run_benchmark(args.benchmark, args.repetitions, args.filter),
+        }
+        os.makedirs(args.baselines, exist_ok=True)
+        with open(path, 'w') as file:
+            json.dump(baseline, file, indent=1)
+            file.write('\n')
+        print('Stored baseline %s' % path)
+        return 0
+
+    if not os.path.exists(path):
+        message = ('no baseline for this host (%s), record one with '
+                   '"compare_benchmarks.py record" and commit it' % path)
+        if args.require_baseline:
+            print('ERROR: ' + message, file=sys.stderr)
+            return 1
+        print('WARNING: %s. The regression check is skipped.' % message, file=sys.stderr)
+        return SKIPPED
+    baseline = load(path)
+    run = run_benchmark(args.benchmark, args.repetitions, args.filter)
+    run = {(r['kernel'], r['channels']): r['ns_per_call'] for r in run['results']}
+    regressions = compare(baseline, run, args.threshold, args.alpha, args.confidence)
+    if regressions:
+        print('%d kernels regressed against %s' % (regressions, path))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,465 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Measures the cost of the realtime kernels of control_toolbox.
+//
+// usage: control_toolbox_benchmark [--counters] [--repetitions N] [--filter TEXT]
+//                                  [--output FILE]
+//
+// Every kernel is run on 1, 8, 64 and 512 channels. A repetition runs
+// enough cycles to last about 10 ms and gives one sample of the time per
+// call, that is per channel and cycle. With --counters the hardware
+// counters of each repetition are reported per call as well; they are
+// skipped with a warning where perf_event_open is not usable. The report
+// is written as JSON.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "control_toolbox/dither.hpp"
+#include "control_toolbox/gain_curve.hpp"
+#include "control_toolbox/limited_proxy.hpp"
+#include "control_toolbox/notch_filter.hpp"
+#include "control_toolbox/online_trajectory_generator.hpp"
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/pid_bank.hpp"
+#include "control_toolbox/reference_prefilter.hpp"
+#include "control_toolbox/s_curve_trajectory.hpp"
+#include "control_toolbox/sine_sweep.hpp"
+#include "control_toolbox/sinusoid.hpp"
+
+#include "perf_counters.hpp"
+
+using control_toolbox::benchmark::PerfCounters;
+
+namespace
+{
+constexpr uint64_t DT = 1000000;  // 1 kHz loop, in nanoseconds
+constexpr double DT_SECONDS = DT / 1e9;
+constexpr std::size_t SIGNAL_LENGTH = 1024;
+
+// Keeps the results of the kernels alive
+volatile double sink;
+
+// One cycle of a kernel over all of its channels
+using Cycle = std::function<void(std::size_t)>;
+
+struct Kernel
+{
+  const char * name;
+  Cycle (*create)(std::size_t); /**< Creates the kernel for a number of channels. */
+};
+
+// Deterministic, slowly varying error signal, different for each channel
+std::vector<double> makeSignal()
+{
+  std::vector<double> signal(SIGNAL_LENGTH);
+  for (std::size_t k = 0; k < SIGNAL_LENGTH; ++k) {
+    signal[k] = std::sin(2.0 * M_PI * k / SIGNAL_LENGTH) + 0.1 * std::sin(0.37 * k);
+  }
+  return signal;
+}
+
+const std::vector<double> & signal()
+{
+  static const std::vector<double> values = makeSignal();
+  return values;
+}
+
+double sample(std::size_t cycle, std::size_t channel)
+{
+  return signal()[(cycle + 7 * channel) % SIGNAL_LENGTH];
+}
+
+Cycle runPids(std::shared_ptr<std::vector<control_toolbox::Pid>> pids)
+{
+  return [pids](std::size_t cycle) {
+    double sum = 0.0;
+    for (std::size_t c = 0; c < pids->size(); ++c) {
+      sum += (*pids)[c].computeCommand(sample(cycle, c), DT);
+    }
+    sink = sum;
+  };
+}
+
+// Plain Pid with fixed gains, the optional features must not slow it down
+Cycle createPidComputeCommand(std::size_t n)
+{
+  return runPids(std::make_shared<std::vector<control_toolbox::Pid>>(
+    n, control_toolbox::Pid(2.0, 1.0, 0.1, 1.0, -1.0)));
+}
+
+Cycle createPidComputeCommandGainCurve(std::size_t n)
+{
+  auto pids = std::make_shared<std::vector<control_toolbox::Pid>>(
+    n, control_toolbox::Pid(2.0, 1.0, 0.1, 1.0, -1.0));
+  const auto curve =
+    control_toolbox::GainCurve::createPiecewiseLinear({0.0, 0.5, 1.0}, {2.0, 1.0, 0.5});
+  for (auto & pid : *pids) {
+    pid.setGainCurve(curve);
+    pid.setGainRampCycles(100);
+  }
+  return runPids(pids);
+}
+
+Cycle createPidBankComputeCommands(std::size_t n)
+{
+  auto bank = std::make_shared<control_toolbox::PidBank>();
+  bank->init(n, control_toolbox::Pid::Gains(2.0, 1.0, 0.1, 1.0, -1.0));
+  auto errors = std::make_shared<std::vector<double>>(n);
+  auto commands = std::make_shared<std::vector<double>>(n);
+  return [bank, errors, commands](std::size_t cycle) {
+    for (std::size_t c = 0; c < errors->size(); ++c) {
+      (*errors)[c] = sample(cycle, c);
+    }
+    bank->computeCommands(*errors, DT, *commands);
+    sink = commands->back();
+  };
+}
+
+Cycle createLimitedProxyUpdate(std::size_t n)
+{
+  control_toolbox::LimitedProxy proxy;
+  proxy.mass_ = 1.0;
+  proxy.Kd_ = 20.0;
+  proxy.Kp_ = 100.0;
+  proxy.Ki_ = 10.0;
+  proxy.Ficl_ = 5.0;
+  proxy.effort_limit_ = 20.0;
+  proxy.vel_limit_ = 1.0;
+  proxy.lambda_proxy_ = 10.0;
+  proxy.acc_converge_ = 10.0;
+  proxy.reset(0.0, 0.0);
+  auto proxies = std::make_shared<std::vector<control_toolbox::LimitedProxy>>(n, proxy);
+  return [proxies](std::size_t cycle) {
+    double sum = 0.0;
+    for (std::size_t c = 0; c < proxies->size(); ++c) {
+      const double target = sample(cycle, c);
+      sum += (*proxies)[c].update(target, 0.0, 0.0, 0.9 * target, 0.0, DT_SECONDS);
+    }
+    sink = sum;
+  };
+}
+
+Cycle createNotchFilterUpdate(std::size_t n)
+{
+  control_toolbox::NotchFilter filter;
+  filter.setCoefficients(
+    {control_toolbox::designNotch(50.0, 5.0, 0.1, 1000.0),
+     control_toolbox::designNotch(120.0, 10.0, 0.1, 1000.0)});
+  auto filters = std::make_shared<std::vector<control_toolbox::NotchFilter>>(n, filter);
+  return [filters](std::size_t cycle) {
+    double sum = 0.0;
+    for (std::size_t c = 0; c < filters->size(); ++c) {
+      sum += (*filters)[c].update(sample(cycle, c));
+    }
+    sink = sum;
+  };
+}
+
+Cycle createReferencePrefilterUpdate(std::size_t n)
+{
+  auto prefilter = std::make_shared<control_toolbox::ReferencePrefilter>();
+  prefilter->initCriticallyDamped(n, 10.0, 1000.0);
+  auto references = std::make_shared<std::vector<double>>(n);
+  auto filtered = std::make_shared<std::vector<double>>(n);
+  return [prefilter, references, filtered](std::size_t cycle) {
+    for (std::size_t c = 0; c < references->size(); ++c) {
+      (*references)[c] = sample(cycle, c);
+    }
+    prefilter->update(*references, *filtered);
+    sink = filtered->back();
+  };
+}
+
+Cycle createDitherUpdate(std::size_t n)
+{
+  auto dithers = std::make_shared<std::vector<control_toolbox::Dither>>(n);
+  for (std::size_t c = 0; c < n; ++c) {
+    (*dithers)[c].init(1.0, static_cast<double>(c + 1));
+  }
+  return [dithers](std::size_t) {
+    double sum = 0.0;
+    for (auto & dither : *dithers) {
+      sum += dither.update();
+    }
+    sink = sum;
+  };
+}
+
+Cycle createSineSweepUpdate(std::size_t n)
+{
+  control_toolbox::SineSweep sweep;
+  sweep.init(1.0, 100.0, 1e6, 1.0);
+  auto sweeps = std::make_shared<std::vector<control_toolbox::SineSweep>>(n, sweep);
+  const auto dt = rclcpp::Duration::from_nanoseconds(DT);
+  return [sweeps, dt](std::size_t) {
+    double sum = 0.0;
+    for (auto & s : *sweeps) {
+      sum += s.update(dt);
+    }
+    sink = sum;
+  };
+}
+
+Cycle createSinusoidUpdate(std::size_t n)
+{
+  auto sinusoids = std::make_shared<std::vector<control_toolbox::Sinusoid>>(
+    n, control_toolbox::Sinusoid(0.0, 1.0, 2.0, 0.0));
+  return [sinusoids](std::size_t cycle) {
+    double sum = 0.0, qd, qdd;
+    for (auto & sinusoid : *sinusoids) {
+      sum += sinusoid.update(cycle * DT_SECONDS, qd, qdd);
+    }
+    sink = sum;
+  };
+}
+
+Cycle createOnlineTrajectoryGeneratorUpdate(std::size_t n)
+{
+  control_toolbox::OnlineTrajectoryGenerator generator;
+  generator.init(1.0, 10.0);
+  auto generators = std::make_shared<
+    std::vector<control_toolbox::OnlineTrajectoryGenerator>>(n, generator);
+  return [generators](std::size_t cycle) {
+    double sum = 0.0, velocity, acceleration;
+    for (std::size_t c = 0; c < generators->size(); ++c) {
+      sum +=
+        (*generators)[c].update(sample(cycle, c), 0.0, DT_SECONDS, velocity, acceleration);
+    }
+    sink = sum;
+  };
+}
+
+Cycle createSCurveTrajectoryUpdate(std::size_t n)
+{
+  control_toolbox::SCurveTrajectory trajectory;
+  trajectory.init(0.0, 1.0, 1.0, 10.0, 100.0);
+  auto trajectories = std::make_shared<
+    std::vector<control_toolbox::SCurveTrajectory>>(n, trajectory);
+  return [trajectories](std::size_t cycle) {
+    double sum = 0.0, qd, qdd;
+    const double duration = trajectories->front().getDuration();
+    const double time = std::fmod(cycle * DT_SECONDS, duration);
+    for (const auto & t : *trajectories) {
+      sum += t.update(time, qd, qdd);
+    }
+    sink = sum;
+  };
+}
+
+std::vector<Kernel> makeKernels()
+{
+  return {
+    {"pid_compute_command", createPidComputeCommand},
+    {"pid_compute_command_gain_curve", createPidComputeCommandGainCurve},
+    {"pid_bank_compute_commands", createPidBankComputeCommands},
+    {"limited_proxy_update", createLimitedProxyUpdate},
+    {"notch_filter_update", createNotchFilterUpdate},
+    {"reference_prefilter_update", createReferencePrefilterUpdate},
+    {"dither_update", createDitherUpdate},
+    {"sine_sweep_update", createSineSweepUpdate},
+    {"sinusoid_update", createSinusoidUpdate},
+    {"online_trajectory_generator_update", createOnlineTrajectoryGeneratorUpdate},
+    {"s_curve_trajectory_update", createSCurveTrajectoryUpdate},
+  };
+}
+
+struct Result
+{
+  std::string kernel;
+  std::size_t channels = 0;
+  std::size_t cycles = 0;                    /**< Cycles per repetition. */
+  std::vector<double> ns_per_call;           /**< One sample per repetition. */
+  std::vector<PerfCounters::Values> counters; /**< Counts per call, one per repetition. */
+};
+
+Result run(
+  const Kernel & kernel, std::size_t channels, std::size_t repetitions, PerfCounters * counters)
+{
+  using Clock = std::chrono::steady_clock;
+  Result result;
+  result.kernel = kernel.name;
+  result.channels = channels;
+
+  Cycle cycle = kernel.create(channels);
+  std::size_t count = 0;
+
+  // Warm up and find the number of cycles lasting about 10 ms
+  std::size_t cycles = 1;
+  for (;;) {
+    const auto start = Clock::now();
+    for (std::size_t k = 0; k < cycles; ++k) {
+      cycle(count++);
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    if (elapsed.count() > 0.01 || cycles >= (1u << 24)) {
+      break;
+    }
+    cycles *= 2;
+  }
+  result.cycles = cycles;
+
+  const double calls = static_cast<double>(cycles) * channels;
+  for (std::size_t r = 0; r < repetitions; ++r) {
+    if (counters) {
+      counters->start();
+    }
+    const auto start = Clock::now();
+    for (std::size_t k = 0; k < cycles; ++k) {
+      cycle(count++);
+    }
+    const auto stop = Clock::now();
+    if (counters) {
+      PerfCounters::Values values;
+      counters->stop(values);
+      for (auto & value : values) {
+        value /= calls;
+      }
+      result.counters.push_back(values);
+    }
+    result.ns_per_call.push_back(
+      std::chrono::duration<double, std::nano>(stop - start).count() / calls);
+  }
+  return result;
+}
+
+void writeJson(
+  std::FILE * file, const std::vector<Result> & results, const PerfCounters * counters)
+{
+  std::fprintf(file, "{\n  \"format_version\": 1,\n  \"results\": [");
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const Result & result = results[i];
+    std::fprintf(
+      file, "%s\n    {\"kernel\": \"%s\", \"channels\": %zu, \"cycles\": %zu,\n",
+      i > 0 ? "," : "", result.kernel.c_str(), result.channels, result.cycles);
+    std::fprintf(file, "     \"ns_per_call\": [");
+    for (std::size_t r = 0; r < result.ns_per_call.size(); ++r) {
+      std::fprintf(file, "%s%.4f", r > 0 ? ", " : "", result.ns_per_call[r]);
+    }
+    std::fprintf(file, "]");
+    if (counters && !result.counters.empty()) {
+      std::fprintf(file, ",\n     \"counters_per_call\": {");
+      bool first = true;
+      for (std::size_t k = 0; k < PerfCounters::NUM_COUNTERS; ++k) {
+        if (!counters->isAvailable(k)) {
+          continue;
+        }
+        std::fprintf(file, "%s\"%s\": [", first ? "" : ", ", PerfCounters::NAMES[k]);
+        for (std::size_t r = 0; r < result.counters.size(); ++r) {
+          std::fprintf(file, "%s%.4f", r > 0 ? ", " : "", result.counters[r][k]);
+        }
+        std::fprintf(file, "]");
+        first = false;
+      }
+      std::fprintf(file, "}");
+    }
+    std::fprintf(file, "}");
+  }
+  std::fprintf(file, "\n  ]\n}\n");
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  bool use_counters = false;
+  std::size_t repetitions = 15;
+  std::string filter;
+  std::string output;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--counters") {
+      use_counters = true;
+    } else if (arg == "--repetitions" && i + 1 < argc) {
+      repetitions = std::max(1l, std::atol(argv[++i]));
+    } else if (arg == "--filter" && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (arg == "--output" && i + 1 < argc) {
+      output = argv[++i];
+    } else {
+      std::fprintf(
+        stderr, "usage: %s [--counters] [--repetitions N] [--filter TEXT] [--output FILE]\n",
+        argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  PerfCounters counters;
+  PerfCounters * active_counters = nullptr;
+  if (use_counters) {
+    if (counters.open()) {
+      active_counters = &counters;
+      for (std::size_t k = 0; k < PerfCounters::NUM_COUNTERS; ++k) {
+        if (!counters.isAvailable(k)) {
+          std::fprintf(stderr, "Counter %s is not available.\n", PerfCounters::NAMES[k]);
+        }
+      }
+    } else {
+      std::fprintf(
+        stderr, "Hardware counters are not available, check perf_event_paranoid. Skipping.\n");
+    }
+  }
+
+  std::vector<Result> results;
+  for (const auto & kernel : makeKernels()) {
+    if (!filter.empty() && std::strstr(kernel.name, filter.c_str()) == nullptr) {
+      continue;
+    }
+    for (std::size_t channels : {1u, 8u, 64u, 512u}) {
+      results.push_back(run(kernel, channels, repetitions, active_counters));
+      auto sorted = results.back().ns_per_call;
+      std::sort(sorted.begin(), sorted.end());
+      std::fprintf(
+        stderr, "%-36s %4zu channels: %9.2f ns/call (median)\n", kernel.name, channels,
+        sorted[sorted.size() / 2]);
+    }
+  }
+
+  std::FILE * file = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "Could not open %s.\n", output.c_str());
+    return EXIT_FAILURE;
+  }
+  writeJson(file, results, active_counters);
+  if (file != stdout) {
+    std::fclose(file);
+  }
+  return EXIT_SUCCESS;
+}
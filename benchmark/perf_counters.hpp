@@ -0,0 +1,105 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__PERF_COUNTERS_HPP_
+#define CONTROL_TOOLBOX__PERF_COUNTERS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace control_toolbox
+{
+namespace benchmark
+{
+/***************************************************/
+/*! \class PerfCounters
+    \brief Hardware counters of the calling thread, read with perf_event_open
+
+    Counts cycles, instructions, branch misses, L1 data cache read
+    misses and last level cache misses in user space. Counters the CPU,
+    the kernel (see /proc/sys/kernel/perf_event_paranoid) or a container
+    do not provide are reported as unavailable, and none are available
+    outside of Linux. When the kernel multiplexes counters the values are
+    scaled by the fraction of the time each counter was running.
+*/
+/***************************************************/
+
+class PerfCounters
+{
+public:
+  static constexpr std::size_t NUM_COUNTERS = 5;
+
+  using Values = std::array<double, NUM_COUNTERS>;
+
+  /*!
+   * \brief Names of the counters, as used in the reports
+   */
+  static const std::array<const char *, NUM_COUNTERS> NAMES;
+
+  PerfCounters();
+
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters & operator=(const PerfCounters &) = delete;
+
+  /*!
+   * \brief Opens the counters
+   * \return False if no counter is available.
+   */
+  bool open();
+
+  /*!
+   * \brief Return true if counter \c k could be opened
+   */
+  bool isAvailable(std::size_t k) const;
+
+  /*!
+   * \brief Resets and starts the counters
+   */
+  void start();
+
+  /*!
+   * \brief Stops the counters and reads them
+   * \param values (output) Count of each counter since start(), 0 if unavailable.
+   */
+  void stop(Values & values);
+
+private:
+  std::array<int, NUM_COUNTERS> fds_; /**< File descriptors, -1 if unavailable. */
+};
+
+}  // namespace benchmark
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__PERF_COUNTERS_HPP_
@@ -0,0 +1,230 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Measures how PidROS scales with the number of instances on one node.
+//
+// usage: pid_ros_scalability [--cycles N] [--output FILE] [instances ...]
+//
+// For each number of instances (10, 100 and 1000 by default) a fresh node
+// gets that many PidROS objects, each with its own parameter and topic
+// prefix. The report gives, per number of instances:
+//  - the time to construct and initialize all instances,
+//  - the growth of the resident memory and of the number of threads of the
+//    process (read from /proc, -1 where it is not available),
+//  - percentiles of the latency of computeCommand including the state
+//    publishing, over all instances and cycles,
+//  - the time to set the p gain of every instance in one atomic parameter
+//    update, which calls the parameter callbacks of all instances.
+// The report is written as JSON.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "control_toolbox/pid_ros.hpp"
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct ProcessStatus
+{
+  long rss_kb = -1;  /**< Resident memory in kB. */
+  long threads = -1; /**< Number of threads. */
+};
+
+ProcessStatus readProcessStatus()
+{
+  ProcessStatus status;
+  std::ifstream file("/proc/self/status");
+  std::string key;
+  while (file >> key) {
+    if (key == "VmRSS:") {
+      file >> status.rss_kb;
+    } else if (key == "Threads:") {
+      file >> status.threads;
+    }
+    file.ignore(1 << 16, '\n');
+  }
+  return status;
+}
+
+double seconds(Clock::duration duration)
+{
+  return std::chrono::duration<double>(duration).count();
+}
+
+struct Report
+{
+  std::size_t instances = 0;
+  double startup_s = 0.0;
+  long rss_growth_kb = -1;
+  long thread_growth = -1;
+  long threads = -1;
+  double latency_p50_us = 0.0;
+  double latency_p99_us = 0.0;
+  double latency_max_us = 0.0;
+  double cycle_p50_us = 0.0; /**< One call of every instance. */
+  double parameter_update_s = 0.0;
+};
+
+double percentile(std::vector<double> & values, double fraction)
+{
+  std::sort(values.begin(), values.end());
+  return values[static_cast<std::size_t>(fraction * (values.size() - 1))];
+}
+
+Report measure(std::size_t instances, std::size_t cycles)
+{
+  Report report;
+  report.instances = instances;
+
+  auto node = std::make_shared<rclcpp::Node>("pid_ros_scalability_" + std::to_string(instances));
+  const ProcessStatus before = readProcessStatus();
+
+  const auto start = Clock::now();
+  std::vector<std::unique_ptr<control_toolbox::PidROS>> pids;
+  pids.reserve(instances);
+  for (std::size_t k = 0; k < instances; ++k) {
+    pids.emplace_back(
+      std::make_unique<control_toolbox::PidROS>(node, "pid_" + std::to_string(k)));
+    pids.back()->initPid(1.0, 0.1, 0.01, 1.0, -1.0, false);
+  }
+  report.startup_s = seconds(Clock::now() - start);
+
+  const ProcessStatus after = readProcessStatus();
+  if (before.rss_kb >= 0 && after.rss_kb >= 0) {
+    report.rss_growth_kb = after.rss_kb - before.rss_kb;
+    report.thread_growth = after.threads - before.threads;
+    report.threads = after.threads;
+  }
+
+  const rclcpp::Duration dt(0, 1000000);
+  std::vector<double> latencies, cycle_latencies;
+  latencies.reserve(instances * cycles);
+  cycle_latencies.reserve(cycles);
+  for (std::size_t c = 0; c < cycles; ++c) {
+    const auto cycle_start = Clock::now();
+    for (std::size_t k = 0; k < instances; ++k) {
+      const auto call_start = Clock::now();
+      pids[k]->computeCommand(0.01 * static_cast<double>((c + k) % 100), dt);
+      latencies.push_back(1e6 * seconds(Clock::now() - call_start));
+    }
+    cycle_latencies.push_back(1e6 * seconds(Clock::now() - cycle_start));
+  }
+  report.latency_p50_us = percentile(latencies, 0.5);
+  report.latency_p99_us = percentile(latencies, 0.99);
+  report.latency_max_us = latencies.back();
+  report.cycle_p50_us = percentile(cycle_latencies, 0.5);
+
+  std::vector<rclcpp::Parameter> parameters;
+  for (std::size_t k = 0; k < instances; ++k) {
+    parameters.emplace_back("pid_" + std::to_string(k) + ".p", 2.0);
+  }
+  const auto update_start = Clock::now();
+  node->set_parameters_atomically(parameters);
+  report.parameter_update_s = seconds(Clock::now() - update_start);
+
+  return report;
+}
+
+void writeJson(std::FILE * file, const std::vector<Report> & reports, std::size_t cycles)
+{
+  std::fprintf(file, "{\n  \"format_version\": 1,\n  \"cycles\": %zu,\n  \"results\": [", cycles);
+  for (std::size_t i = 0; i < reports.size(); ++i) {
+    const Report & r = reports[i];
+    std::fprintf(
+      file,
+      "%s\n    {\"instances\": %zu, \"startup_s\": %.6f, \"rss_growth_kb\": %ld, "
+      "\"thread_growth\": %ld, \"threads\": %ld,\n"
+      "     \"compute_command_us\": {\"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f}, "
+      "\"cycle_p50_us\": %.3f, \"parameter_update_s\": %.6f}",
+      i > 0 ? "," : "", r.instances, r.startup_s, r.rss_growth_kb, r.thread_growth, r.threads,
+      r.latency_p50_us, r.latency_p99_us, r.latency_max_us, r.cycle_p50_us,
+      r.parameter_update_s);
+  }
+  std::fprintf(file, "\n  ]\n}\n");
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+
+  std::size_t cycles = 200;
+  std::string output;
+  std::vector<std::size_t> instances;
+  const auto args = rclcpp::remove_ros_arguments(argc, argv);
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    if (args[i] == "--cycles" && i + 1 < args.size()) {
+      cycles = std::max(1l, std::atol(args[++i].c_str()));
+    } else if (args[i] == "--output" && i + 1 < args.size()) {
+      output = args[++i];
+    } else if (std::atol(args[i].c_str()) > 0) {
+      instances.push_back(std::atol(args[i].c_str()));
+    } else {
+      std::fprintf(stderr, "usage: %s [--cycles N] [--output FILE] [instances ...]\n", argv[0]);
+      rclcpp::shutdown();
+      return EXIT_FAILURE;
+    }
+  }
+  if (instances.empty()) {
+    instances = {10, 100, 1000};
+  }
+
+  std::vector<Report> reports;
+  for (std::size_t n : instances) {
+    reports.push_back(measure(n, cycles));
+    std::fprintf(
+      stderr, "%5zu instances: startup %.3f s, %ld threads, computeCommand p99 %.2f us\n", n,
+      reports.back().startup_s, reports.back().threads, reports.back().latency_p99_us);
+  }
+  rclcpp::shutdown();
+
+  std::FILE * file = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "Could not open %s.\n", output.c_str());
+    return EXIT_FAILURE;
+  }
+  writeJson(file, reports, cycles);
+  if (file != stdout) {
+    std::fclose(file);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__DELAY_ESTIMATOR_HPP_
+#define CONTROL_TOOLBOX__DELAY_ESTIMATOR_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class DelayEstimator
+    \brief Estimates the delay between an excitation and a measured response
+
+    This class estimates the dead time between a broadband excitation
+    (e.g. the white noise given by Dither) and the measured response of
+    the system, as the lag of the maximum of their cross-correlation
+    over a fixed window of lags \f$k \in [0, K]\f$.<br>
+
+    The cross-correlation is updated recursively with a forgetting
+    factor \f$\lambda\f$ at every sample,<br>
+
+    \f$r_k(n) = \lambda r_k(n-1) + (1 - \lambda) \tilde{y}(n) \tilde{u}(n-k)\f$<br>
+
+    where \f$\tilde{u}\f$ and \f$\tilde{y}\f$ are the excitation and the
+    response with their (also recursively estimated) mean removed. An
+    update costs \f$O(K)\f$ and no memory is allocated after init(), so
+    the estimator can run in the realtime loop and track slow drifts of
+    the delay, e.g. of a communication latency. The lag of the peak is
+    refined with a parabolic interpolation to a fraction of a sample.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC DelayEstimator
+{
+public:
+  /*!
+   * \brief Constructor
+   */
+  DelayEstimator();
+
+  /*!
+   * \brief Allocates the history and the correlation window. Not realtime safe.
+   *
+   * \param max_lag Largest delay that can be detected, in samples.
+   * \param forgetting_factor Forgetting factor \f$\lambda\f$, in (0, 1). The
+   *        correlation averages over about \f$1 / (1 - \lambda)\f$ samples.
+   */
+  bool init(std::size_t max_lag, double forgetting_factor);
+
+  /*!
+   * \brief Update the correlation with a new pair of samples. Called in RT loop.
+   *
+   * Pairs with a sample that is not finite are ignored.
+   *
+   * \param input Excitation applied at this sample.
+   * \param output Response measured at this sample.
+   */
+  void update(double input, double output);
+
+  /*!
+   * \brief Clear the history and the correlation
+   */
+  void reset();
+
+  /*!
+   * \brief Return the estimated delay, in samples
+   */
+  double getDelay() const;
+
+  /*!
+   * \brief Return the normalized correlation at the estimated delay, in [-1, 1]
+   *
+   * Its magnitude tells how much of the response is explained by the delayed
+   * excitation, values close to zero mean the estimate is not reliable.
+   */
+  double getConfidence() const;
+
+  /*!
+   * \brief Return the cross-correlation for the given lag
+   */
+  double getCorrelation(std::size_t lag) const;
+
+private:
+  std::vector<double> history_;     /**< Circular history of the centered excitation. */
+  std::vector<double> correlation_; /**< Cross-correlation for each lag. */
+  std::size_t head_;                /**< Position of the newest sample in history_. */
+  double forgetting_factor_;        /**< Forgetting factor. */
+  double input_mean_;               /**< Mean of the excitation. */
+  double output_mean_;              /**< Mean of the response. */
+  double input_power_;              /**< Variance of the excitation. */
+  double output_power_;             /**< Variance of the response. */
+  std::size_t peak_;                /**< Lag of the maximum of the correlation. */
+  double delay_;                    /**< Interpolated delay. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__DELAY_ESTIMATOR_HPP_
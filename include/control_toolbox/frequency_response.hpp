@@ -0,0 +1,175 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__FREQUENCY_RESPONSE_HPP_
+#define CONTROL_TOOLBOX__FREQUENCY_RESPONSE_HPP_
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/*!
+ * \brief Frequency response sampled on a grid of frequencies
+ */
+struct FrequencyResponse
+{
+  double sample_rate = 0.0;                   /**< Sample rate of the data, 0 if continuous. */
+  std::vector<double> frequencies;            /**< Frequencies in Hz. */
+  std::vector<std::complex<double>> response; /**< Complex response at each frequency. */
+  std::vector<double> coherence;              /**< Magnitude squared coherence, may be empty. */
+};
+
+/*!
+ * \brief Gain and phase margins of an open loop and bandwidth of the closed loop
+ */
+struct StabilityMargins
+{
+  double gain_margin = 0.0;               /**< Gain margin (ratio), infinite if none. */
+  double phase_margin = 0.0;              /**< Phase margin in degrees, infinite if none. */
+  double gain_crossover_frequency = 0.0;  /**< Frequency in Hz where the loop gain is 1. */
+  double phase_crossover_frequency = 0.0; /**< Frequency in Hz where the phase is -180. */
+  double bandwidth = 0.0; /**< Closed loop -3 dB frequency in Hz, infinite if off grid. */
+};
+
+/***************************************************/
+/*! \class FrequencyResponseEstimator
+    \brief Estimates a frequency response from input/output records
+
+    This class estimates the frequency response of a system from
+    an excitation (e.g. generated with SineSweep or Dither) and the
+    measured response, using Welch's method of averaged, overlapping
+    and Hann-windowed segments and the H1 estimator:<br>
+
+    \f$H_1(f) = \frac{P_{xy}(f)}{P_{xx}(f)}\f$<br>
+
+    The coherence \f$\gamma^2 = |P_{xy}|^2 / (P_{xx} P_{yy})\f$ is
+    returned alongside to judge the quality of each bin.
+
+    The FFT is a radix-2 implementation without external dependencies,
+    both real records are transformed at once with a single complex FFT.
+    Segments can be processed in parallel by several worker threads.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC FrequencyResponseEstimator
+{
+public:
+  /*!
+   * \brief Constructor
+   */
+  FrequencyResponseEstimator();
+
+  /*!
+   * \brief Precomputes the window and the FFT tables. Not realtime safe.
+   *
+   * \param segment_length Number of samples per segment, must be a power of two.
+   * \param overlap Fraction of overlap between consecutive segments, in [0, 1).
+   * \param sample_rate Sample rate of the records in Hz.
+   * \param num_threads Number of worker threads, 0 uses the hardware concurrency.
+   */
+  bool init(
+    std::size_t segment_length, double overlap, double sample_rate, std::size_t num_threads = 1);
+
+  /*!
+   * \brief Estimates the frequency response from \c input to \c output.
+   *
+   * The DC bin is omitted, the returned frequencies go from one
+   * frequency resolution step up to the Nyquist frequency.
+   *
+   * \param input Excitation record.
+   * \param output Response record, same length as \c input.
+   * \param response (output) Estimated frequency response and coherence.
+   * \return False if not initialized or if the records are shorter than a segment.
+   */
+  bool estimate(
+    const std::vector<double> & input, const std::vector<double> & output,
+    FrequencyResponse & response) const;
+
+private:
+  void transform(std::vector<std::complex<double>> & data) const;
+
+  std::size_t segment_length_;                 /**< Samples per segment. */
+  std::size_t step_;                           /**< Samples between segment starts. */
+  double sample_rate_;                         /**< Sample rate in Hz. */
+  std::size_t num_threads_;                    /**< Number of worker threads. */
+  std::vector<double> window_;                 /**< Hann window. */
+  std::vector<std::complex<double>> twiddles_; /**< FFT twiddle factors. */
+  std::vector<std::size_t> bit_reversal_;      /**< FFT bit reversal permutation. */
+};
+
+/*!
+ * \brief Evaluates the response of a Pid with the given gains.
+ *
+ * If \c sample_rate is positive, the discrete integration and
+ * differentiation schemes of Pid::computeCommand are used, otherwise
+ * \f$C(s) = K_p + K_i / s + K_d s\f$. The integral clamp is ignored.
+ *
+ * \param gains Gains of the Pid.
+ * \param frequency Frequency in Hz.
+ * \param sample_rate Rate at which the Pid is updated, in Hz.
+ */
+CONTROL_TOOLBOX_PUBLIC std::complex<double> evaluatePidResponse(
+  const Pid::Gains & gains, double frequency, double sample_rate);
+
+/*!
+ * \brief Computes the open loop response of a Pid in series with a plant.
+ *
+ * \param plant Frequency response of the plant.
+ * \param gains Gains of the Pid.
+ * \param loop (output) Open loop response, on the frequencies of \c plant.
+ */
+CONTROL_TOOLBOX_PUBLIC void computeLoopResponse(
+  const FrequencyResponse & plant, const Pid::Gains & gains, FrequencyResponse & loop);
+
+/*!
+ * \brief Computes gain and phase margins of an open loop and the closed loop bandwidth.
+ *
+ * Crossovers are interpolated linearly in log-frequency between grid points
+ * and the phase is unwrapped along the grid. The bandwidth is the first
+ * frequency where the closed loop \f$L / (1 + L)\f$ drops 3 dB below its
+ * value at the lowest frequency of the grid.
+ *
+ * \param loop Open loop frequency response, with increasing frequencies.
+ * \param margins (output) The computed margins.
+ * \return False if the response has less than two points.
+ */
+CONTROL_TOOLBOX_PUBLIC bool computeStabilityMargins(
+  const FrequencyResponse & loop, StabilityMargins & margins);
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__FREQUENCY_RESPONSE_HPP_
@@ -0,0 +1,189 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__FRICTION_COMPENSATION_HPP_
+#define CONTROL_TOOLBOX__FRICTION_COMPENSATION_HPP_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/*!
+ * \brief Parameters of a Coulomb, viscous and Stribeck friction model
+ *
+ * \f$F(v) = \mathrm{sign}(v) \left[F_c + (F_s - F_c) e^{-(v / v_s)^2}\right] + F_v v\f$
+ */
+struct FrictionParameters
+{
+  double coulomb = 0.0;           /**< Coulomb friction \f$F_c\f$. */
+  double static_friction = 0.0;   /**< Breakaway friction \f$F_s\f$. */
+  double viscous = 0.0;           /**< Viscous coefficient \f$F_v\f$. */
+  double stribeck_velocity = 0.0; /**< Stribeck velocity \f$v_s\f$. */
+};
+
+/*!
+ * \brief Evaluates the friction model at the given velocity, 0 at rest.
+ */
+CONTROL_TOOLBOX_PUBLIC double computeFrictionForce(
+  const FrictionParameters & parameters, double velocity);
+
+/***************************************************/
+/*! \class FrictionIdentifier
+    \brief Fits the friction model to velocity/force samples
+
+    Samples are the mean velocity and force of constant velocity
+    segments of a slow sweep, or low speed samples taken while a
+    Dither keeps the joint from sticking. For a given Stribeck
+    velocity the model is linear in \f$F_c\f$, \f$F_s\f$ and \f$F_v\f$,
+    so the least squares problem is accumulated incrementally in its
+    normal equations for a fixed set of Stribeck velocity candidates.
+    Adding a sample costs a few hundred flops and no sample is stored,
+    fit() picks the candidate with the smallest residual.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC FrictionIdentifier
+{
+public:
+  static constexpr std::size_t NUM_CANDIDATES = 32;
+
+  /*!
+   * \brief Constructor
+   */
+  FrictionIdentifier();
+
+  /*!
+   * \brief Sets the range of Stribeck velocities, candidates are spaced logarithmically.
+   *
+   * \param min_stribeck_velocity Smallest Stribeck velocity, > 0.
+   * \param max_stribeck_velocity Largest Stribeck velocity.
+   * \param velocity_deadband Samples slower than this are ignored as their direction is unknown.
+   */
+  bool init(
+    double min_stribeck_velocity, double max_stribeck_velocity, double velocity_deadband = 0.0);
+
+  /*!
+   * \brief Add a sample to the fit.
+   *
+   * \param velocity Velocity of the joint.
+   * \param force Force (or torque) needed to hold that velocity.
+   * \param weight Weight of the sample, e.g. the length of a constant velocity segment.
+   */
+  void addSample(double velocity, double force, double weight = 1.0);
+
+  /*!
+   * \brief Fit the model to the samples added so far.
+   * \param parameters (output) The fitted parameters.
+   * \return False if not initialized or if no sample was added.
+   */
+  bool fit(FrictionParameters & parameters) const;
+
+  /*!
+   * \brief Return the number of samples used so far
+   */
+  std::size_t getNumSamples() const;
+
+  /*!
+   * \brief Forget all samples
+   */
+  void reset();
+
+private:
+  /// Normal equations of the least squares problem for one Stribeck velocity
+  struct NormalEquations
+  {
+    std::array<double, 9> ata; /**< Regressor outer products (3x3, row major). */
+    std::array<double, 3> atb; /**< Regressor times force. */
+    double btb;                /**< Squared force. */
+  };
+
+  std::array<double, NUM_CANDIDATES> candidates_;         /**< Stribeck velocities. */
+  std::array<NormalEquations, NUM_CANDIDATES> equations_; /**< One problem per candidate. */
+  std::size_t num_samples_;                               /**< Samples added. */
+  double velocity_deadband_;                              /**< Slowest accepted velocity. */
+  bool initialized_;
+};
+
+/***************************************************/
+/*! \class FrictionCompensator
+    \brief Friction feedforward from a precomputed table
+
+    The friction model is tabulated on a uniform velocity grid, so it is
+    evaluated in constant time by linear interpolation. Around zero
+    velocity the sign change is replaced by a linear ramp to avoid
+    chattering. The output is meant to be added to the Pid command:
+
+    \verbatim
+    double effort = pid.computeCommand(error, dt) + compensator.compute(velocity);
+    \endverbatim
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC FrictionCompensator
+{
+public:
+  /*!
+   * \brief Constructor, compensates nothing until initialized
+   */
+  FrictionCompensator();
+
+  /*!
+   * \brief Tabulates the friction model. Not realtime safe.
+   *
+   * \param parameters Friction model.
+   * \param max_velocity Largest tabulated velocity, the model is extrapolated beyond.
+   * \param table_size Number of grid points, at least 3.
+   * \param velocity_deadband Half width of the ramp around zero velocity.
+   */
+  bool init(
+    const FrictionParameters & parameters, double max_velocity, std::size_t table_size,
+    double velocity_deadband);
+
+  /*!
+   * \brief Return the friction force to compensate at the given velocity. Called in RT loop.
+   */
+  double compute(double velocity) const;
+
+private:
+  FrictionParameters parameters_; /**< Friction model. */
+  std::vector<double> table_;     /**< Model on the velocity grid. */
+  double max_velocity_;           /**< Velocity of the last grid point. */
+  double inverse_step_;           /**< Inverse of the grid spacing. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__FRICTION_COMPENSATION_HPP_
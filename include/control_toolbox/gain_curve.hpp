@@ -0,0 +1,111 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__GAIN_CURVE_HPP_
+#define CONTROL_TOOLBOX__GAIN_CURVE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class GainCurve
+    \brief Immutable gain scale as a function of the error magnitude
+
+    A curve is either piecewise linear through breakpoints, or a
+    polynomial. It is built once outside the realtime loop and shared
+    as a pointer to const, so it can be published to the loop by
+    swapping the pointer, see Pid::setGainCurve().
+
+    Piecewise linear curves are evaluated in constant time: a uniform
+    grid over the breakpoints gives the segment to start from, and the
+    grid is fine enough that it is at most one breakpoint away. The grid
+    has at most MAX_GRID_CELLS cells, which bounds how close breakpoints
+    can be relative to the range they cover.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC GainCurve
+{
+public:
+  static constexpr std::size_t MAX_GRID_CELLS = 4096;
+
+  /*!
+   * \brief Creates a piecewise linear curve. Not realtime safe.
+   *
+   * The curve is constant beyond the first and last breakpoints.
+   *
+   * \param errors Error magnitudes of the breakpoints, non negative and strictly increasing.
+   * \param scales Gain scale at each breakpoint.
+   * \return The curve, or nullptr if the breakpoints are invalid, or if the closest ones are
+   *         less than (last - first) / (MAX_GRID_CELLS - 1) apart.
+   */
+  static std::shared_ptr<const GainCurve> createPiecewiseLinear(
+    const std::vector<double> & errors, const std::vector<double> & scales);
+
+  /*!
+   * \brief Creates a polynomial curve. Not realtime safe.
+   *
+   * \param coefficients Coefficients \f$c_0, c_1, \ldots\f$ of
+   *        \f$s(|e|) = \sum_k c_k |e|^k\f$.
+   * \param max_error The curve is constant beyond this error magnitude.
+   * \return The curve, or nullptr if there are no coefficients.
+   */
+  static std::shared_ptr<const GainCurve> createPolynomial(
+    const std::vector<double> & coefficients, double max_error);
+
+  /*!
+   * \brief Evaluates the gain scale. Realtime safe.
+   * \param error Error, only its magnitude is used.
+   */
+  double evaluate(double error) const;
+
+private:
+  GainCurve();
+
+  bool polynomial_;                  /**< True for a polynomial curve. */
+  std::vector<double> errors_;       /**< Breakpoints of a piecewise linear curve. */
+  std::vector<double> scales_;       /**< Scales at the breakpoints. */
+  std::vector<double> slopes_;       /**< Slope of each segment. */
+  std::vector<std::size_t> grid_;    /**< First segment of each grid cell. */
+  double inverse_cell_width_;        /**< Inverse of the width of a grid cell. */
+  std::vector<double> coefficients_; /**< Coefficients of a polynomial curve. */
+  double max_error_;                 /**< End of the polynomial curve. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__GAIN_CURVE_HPP_
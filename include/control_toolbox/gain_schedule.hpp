@@ -0,0 +1,172 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__GAIN_SCHEDULE_HPP_
+#define CONTROL_TOOLBOX__GAIN_SCHEDULE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "control_toolbox/limited_proxy.hpp"
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/*!
+ * \brief Parameters of a LimitedProxy, as stored in a GainSchedule
+ */
+struct CONTROL_TOOLBOX_PUBLIC LimitedProxyParameters
+{
+  double mass = 0.0;            /**< Estimate of the joint mass. */
+  double Kd = 0.0;              /**< Damping gain. */
+  double Kp = 0.0;              /**< Position gain. */
+  double Ki = 0.0;              /**< Integral gain. */
+  double Ficl = 0.0;            /**< Integral force clamp. */
+  double effort_limit = 0.0;    /**< Limit on output force. */
+  double vel_limit = 0.0;       /**< Limit on velocity. */
+  double pos_upper_limit = 0.0; /**< Upper position bound. */
+  double pos_lower_limit = 0.0; /**< Lower position bound. */
+  double lambda_proxy = 0.0;    /**< Bandwidth of proxy reconvergence. */
+  double acc_converge = 0.0;    /**< Acceleration of proxy reconvergence. */
+
+  /*!
+   * \brief Copy the parameters into a proxy, its state is kept. Realtime safe.
+   */
+  void applyTo(LimitedProxy & proxy) const;
+};
+
+/***************************************************/
+/*! \class GainSchedule
+    \brief Immutable tables of gains loaded from a memory mapped file
+
+    A schedule holds a table of Pid::Gains and a table of
+    LimitedProxyParameters, each indexed by strictly increasing
+    breakpoints of a scheduling variable, e.g. a position or a speed.
+    Gains are interpolated linearly between breakpoints, proxy
+    parameters are those of the last breakpoint below the variable.
+    Both are constant beyond the first and last breakpoints.
+
+    The tables are stored in a flat binary file, written with write():
+    a header with a magic number, a version, the size of the tables and
+    a checksum, followed by the breakpoints and the values of each
+    table as native doubles. load() maps the file read-only and
+    validates it once, the tables are then read in place, so loading
+    does not parse anything and processes loading the same file share
+    its pages.
+
+    Like GainCurve, a schedule is shared as a pointer to const, so it
+    can be published to the realtime loop by swapping the pointer, see
+    Pid::setGainSchedule(). Lookups are binary searches.
+
+    Only available on POSIX systems, load() fails elsewhere.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC GainSchedule
+{
+public:
+  /*!
+   * \brief Unmaps the file
+   */
+  ~GainSchedule();
+
+  GainSchedule(const GainSchedule &) = delete;
+  GainSchedule & operator=(const GainSchedule &) = delete;
+
+  /*!
+   * \brief Writes a schedule file. Not realtime safe.
+   *
+   * The file is written next to \c path and renamed over it, so processes
+   * that mapped a previous version keep reading a consistent one.
+   *
+   * \param path Path of the file.
+   * \param gain_breakpoints Breakpoints of the gains, finite and strictly increasing.
+   * \param gains Gains at each breakpoint.
+   * \param proxy_breakpoints Breakpoints of the proxy parameters, finite and strictly increasing.
+   * \param proxy_parameters Proxy parameters at each breakpoint.
+   * \return False if a table is invalid, both are empty or the file could not be written.
+   */
+  static bool write(
+    const std::string & path, const std::vector<double> & gain_breakpoints,
+    const std::vector<Pid::Gains> & gains, const std::vector<double> & proxy_breakpoints = {},
+    const std::vector<LimitedProxyParameters> & proxy_parameters = {});
+
+  /*!
+   * \brief Maps and validates a schedule file. Not realtime safe.
+   * \return The schedule, or nullptr if the file could not be mapped or is invalid.
+   */
+  static std::shared_ptr<const GainSchedule> load(const std::string & path);
+
+  /*!
+   * \brief Return the number of breakpoints of the gains
+   */
+  std::size_t getNumGains() const;
+
+  /*!
+   * \brief Return the number of breakpoints of the proxy parameters
+   */
+  std::size_t getNumProxyParameters() const;
+
+  /*!
+   * \brief Get the gains at a value of the scheduling variable. Realtime safe.
+   *
+   * The antiwindup flag is the one of the breakpoint below \c value.
+   * Default gains are returned if the table is empty.
+   */
+  Pid::Gains getGains(double value) const;
+
+  /*!
+   * \brief Get the proxy parameters at a value of the scheduling variable. Realtime safe.
+   *
+   * Default parameters are returned if the table is empty.
+   */
+  LimitedProxyParameters getProxyParameters(double value) const;
+
+private:
+  GainSchedule();
+
+  void * memory_;                    /**< Mapped file. */
+  std::size_t size_;                 /**< Size of the mapping. */
+  std::size_t num_gains_;            /**< Number of gain breakpoints. */
+  std::size_t num_proxy_parameters_; /**< Number of proxy breakpoints. */
+  const double * gain_breakpoints_;  /**< Breakpoints of the gains. */
+  const double * gains_;             /**< Gains, GAIN_FIELDS per breakpoint. */
+  const double * proxy_breakpoints_; /**< Breakpoints of the proxy parameters. */
+  const double * proxy_parameters_;  /**< Proxy parameters, PROXY_FIELDS per breakpoint. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__GAIN_SCHEDULE_HPP_
@@ -0,0 +1,307 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__MIMO_PID_HPP_
+#define CONTROL_TOOLBOX__MIMO_PID_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "realtime_tools/realtime_buffer.h"
+
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/pid_math.hpp"
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class MimoPid
+    \brief Fixed size pid with gain matrices and static decoupling
+
+    This class implements a pid on N coupled errors producing M
+    commands:<br>
+
+    \f$u = T (K_p e + K_i \int e\,dt + K_d \dot{e})\f$<br>
+
+    where \f$K_p, K_i, K_d\f$ are M x N gain matrices and \f$T\f$ is an
+    M x M decoupling (mixing) matrix, e.g. to map axis efforts to the
+    motors of a gantry. The products of the decoupling matrix with the
+    gain matrices are computed when the gains are set, so each update
+    is a single fused pass over the rows of the three matrices.
+
+    The integral is accumulated per output, \f$T K_i \int e\,dt\f$, and
+    i_max and i_min bound each output as Pid does for its single one:
+    with the antiwindup of that output the accumulated integral is
+    clamped, otherwise only its contribution to the command is. As the integral is kept in
+    output space, changing \f$K_i\f$ does not change the accumulated
+    integral term.
+
+    All storage is inline. The gains are handed to the realtime loop as
+    one block through a realtime buffer.
+*/
+/***************************************************/
+
+template <std::size_t N, std::size_t M = N>
+class MimoPid
+{
+public:
+  using InputVector = std::array<double, N>;
+  using OutputVector = std::array<double, M>;
+  using GainMatrix = std::array<double, M * N>;       /**< Row major, M rows and N columns. */
+  using DecouplingMatrix = std::array<double, M * M>; /**< Row major, M rows and M columns. */
+  using AntiwindupVector = std::array<bool, M>;
+
+  /*!
+   * \brief Store gains in a struct to allow easier realtime buffer usage
+   */
+  struct Gains
+  {
+    Gains() : p(), i(), d(), decoupling(), i_max(), i_min(), antiwindup()
+    {
+      for (std::size_t r = 0; r < M; ++r) {
+        decoupling[r * M + r] = 1.0;
+      }
+    }
+
+    GainMatrix p;                /**< Proportional gains. */
+    GainMatrix i;                /**< Integral gains. */
+    GainMatrix d;                /**< Derivative gains. */
+    DecouplingMatrix decoupling; /**< Decoupling matrix, identity by default. */
+    OutputVector i_max;          /**< Maximum allowable integral term of each output. */
+    OutputVector i_min;          /**< Minimum allowable integral term of each output. */
+    AntiwindupVector antiwindup; /**< Antiwindup of each output. */
+  };
+
+  /*!
+   * \brief Builds diagonal gains with the semantics of one Pid per axis, antiwindup included
+   */
+  static Gains diagonalGains(const std::array<Pid::Gains, N> & axes)
+  {
+    static_assert(N == M, "Diagonal gains need as many outputs as inputs");
+    Gains gains;
+    for (std::size_t k = 0; k < N; ++k) {
+      gains.p[k * N + k] = axes[k].p_gain_;
+      gains.i[k * N + k] = axes[k].i_gain_;
+      gains.d[k * N + k] = axes[k].d_gain_;
+      gains.i_max[k] = axes[k].i_max_;
+      gains.i_min[k] = axes[k].i_min_;
+      gains.antiwindup[k] = axes[k].antiwindup_;
+    }
+    return gains;
+  }
+
+  /*!
+   * \brief Constructor, all gains are zero
+   */
+  MimoPid() : gains_buffer_()
+  {
+    setGains(Gains());
+    reset();
+  }
+
+  /*!
+   * \brief Copy constructor required for preventing mutexes from being copied
+   */
+  MimoPid(const MimoPid & source)
+  {
+    gains_buffer_ = source.gains_buffer_;
+    reset();
+  }
+
+  MimoPid & operator=(const MimoPid & source)
+  {
+    if (this != &source) {
+      gains_buffer_ = source.gains_buffer_;
+      reset();
+    }
+    return *this;
+  }
+
+  /*!
+   * \brief Set the gains, precomputing their products with the decoupling matrix. Not realtime
+   *        safe.
+   */
+  void setGains(const Gains & gains)
+  {
+    Coefficients coefficients;
+    coefficients.gains = gains;
+    for (std::size_t r = 0; r < M; ++r) {
+      for (std::size_t c = 0; c < N; ++c) {
+        double p = 0.0, i = 0.0, d = 0.0;
+        for (std::size_t k = 0; k < M; ++k) {
+          const double t = gains.decoupling[r * M + k];
+          p += t * gains.p[k * N + c];
+          i += t * gains.i[k * N + c];
+          d += t * gains.d[k * N + c];
+        }
+        coefficients.p[r * N + c] = p;
+        coefficients.i[r * N + c] = i;
+        coefficients.d[r * N + c] = d;
+      }
+    }
+    gains_buffer_.writeFromNonRT(coefficients);
+  }
+
+  /*!
+   * \brief Get the gains
+   */
+  Gains getGains() { return gains_buffer_.readFromRT()->gains; }
+
+  /*!
+   * \brief Reset the state of the controller
+   */
+  void reset()
+  {
+    error_last_.fill(0.0);
+    error_.fill(0.0);
+    error_dot_.fill(0.0);
+    i_term_.fill(0.0);
+    cmd_.fill(0.0);
+  }
+
+  /*!
+   * \brief Compute the commands, differentiating the errors. Called in RT loop.
+   *
+   * \param error Errors since last call (error = target - state).
+   * \param dt Change in time since last call in nanoseconds.
+   * \return The commands, zero if dt is 0 or an error is not finite.
+   */
+  OutputVector computeCommand(const InputVector & error, uint64_t dt)
+  {
+    if (dt == 0 || !allFinite(error)) {
+      return OutputVector();
+    }
+    InputVector error_dot;
+    for (std::size_t c = 0; c < N; ++c) {
+      error_dot[c] = (error[c] - error_last_[c]) / (dt / 1e9);
+    }
+    error_last_ = error;
+    return computeCommand(error, error_dot, dt);
+  }
+
+  /*!
+   * \brief Compute the commands with given error derivatives. Called in RT loop.
+   *
+   * \param error Errors since last call (error = target - state).
+   * \param error_dot Derivatives of the errors.
+   * \param dt Change in time since last call in nanoseconds.
+   * \return The commands, zero if dt is 0 or an input is not finite.
+   */
+  OutputVector computeCommand(const InputVector & error, const InputVector & error_dot, uint64_t dt)
+  {
+    if (dt == 0 || !allFinite(error) || !allFinite(error_dot)) {
+      return OutputVector();
+    }
+    const Coefficients & coefficients = *gains_buffer_.readFromRT();
+    const Gains & gains = coefficients.gains;
+    const double seconds = dt / 1e9;
+    error_ = error;
+    error_dot_ = error_dot;
+
+    for (std::size_t r = 0; r < M; ++r) {
+      const double * p = &coefficients.p[r * N];
+      const double * i = &coefficients.i[r * N];
+      const double * d = &coefficients.d[r * N];
+      double p_term = 0.0, i_rate = 0.0, d_term = 0.0;
+      for (std::size_t c = 0; c < N; ++c) {
+        p_term += p[c] * error[c];
+        i_rate += i[c] * error[c];
+        d_term += d[c] * error_dot[c];
+      }
+
+      i_term_[r] += seconds * i_rate;
+      double i_term;
+      if (gains.antiwindup[r]) {
+        // Prevent the integral from climbing higher than permitted by i_max/i_min
+        i_term_[r] = pid_math::clamp(i_term_[r], gains.i_min[r], gains.i_max[r]);
+        i_term = i_term_[r];
+      } else {
+        // Limit i_term so that the limit is meaningful in the output
+        i_term = pid_math::clamp(i_term_[r], gains.i_min[r], gains.i_max[r]);
+      }
+
+      cmd_[r] = p_term + i_term + d_term;
+    }
+    return cmd_;
+  }
+
+  /*!
+   * \brief Return the commands of the last update
+   */
+  const OutputVector & getCurrentCmd() const { return cmd_; }
+
+  /*!
+   * \brief Return the accumulated integral term of each output, before the output clamp
+   */
+  const OutputVector & getIntegralTerm() const { return i_term_; }
+
+  /*!
+   * \brief Return the errors and their derivatives of the last update
+   */
+  void getCurrentErrors(InputVector & error, InputVector & error_dot) const
+  {
+    error = error_;
+    error_dot = error_dot_;
+  }
+
+private:
+  struct Coefficients
+  {
+    Gains gains;  /**< Gains as set. */
+    GainMatrix p; /**< Decoupling times proportional gains. */
+    GainMatrix i; /**< Decoupling times integral gains. */
+    GainMatrix d; /**< Decoupling times derivative gains. */
+  };
+
+  template <typename VectorT>
+  static bool allFinite(const VectorT & v)
+  {
+    return std::all_of(v.begin(), v.end(), [](double x) { return std::isfinite(x); });
+  }
+
+  // Store the gains in a realtime buffer to allow updating them without blocking the realtime
+  // update loop
+  realtime_tools::RealtimeBuffer<Coefficients> gains_buffer_;
+
+  InputVector error_last_; /**< Errors of the last update, for the derivative. */
+  InputVector error_;      /**< Errors of the last update. */
+  InputVector error_dot_;  /**< Error derivatives of the last update. */
+  OutputVector i_term_;    /**< Accumulated integral term of each output. */
+  OutputVector cmd_;       /**< Commands of the last update. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__MIMO_PID_HPP_
@@ -0,0 +1,190 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__NOTCH_FILTER_HPP_
+#define CONTROL_TOOLBOX__NOTCH_FILTER_HPP_
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "realtime_tools/realtime_buffer.h"
+
+#include "control_toolbox/frequency_response.hpp"
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/*!
+ * \brief Coefficients of a discrete second order section
+ *
+ * \f$H(z) = \frac{b_0 + b_1 z^{-1} + b_2 z^{-2}}{1 + a_1 z^{-1} + a_2 z^{-2}}\f$
+ */
+struct CONTROL_TOOLBOX_PUBLIC BiquadCoefficients
+{
+  double b0 = 1.0;
+  double b1 = 0.0;
+  double b2 = 0.0;
+  double a1 = 0.0;
+  double a2 = 0.0;
+
+  /*!
+   * \brief Evaluates the response of the section
+   * \param frequency Frequency in Hz.
+   * \param sample_rate Sample rate in Hz.
+   */
+  std::complex<double> response(double frequency, double sample_rate) const;
+};
+
+/*!
+ * \brief A resonance found in a frequency response
+ */
+struct Resonance
+{
+  double frequency = 0.0;  /**< Frequency of the peak in Hz. */
+  double prominence = 0.0; /**< Height of the peak above its surroundings in dB. */
+  double width = 0.0;      /**< Width of the peak at -3 dB from its top, in Hz. */
+};
+
+/*!
+ * \brief Designs a notch section.
+ *
+ * The analog notch<br>
+ *
+ * \f$H(s) = \frac{s^2 + 2 d \zeta \omega s + \omega^2}{s^2 + 2 \zeta \omega s + \omega^2}\f$<br>
+ *
+ * with \f$\zeta = w / (2 f)\f$ is discretized with a prewarped bilinear
+ * transform, so the gain at \c frequency is exactly \c depth.
+ *
+ * \param frequency Center frequency in Hz, below the Nyquist frequency.
+ * \param width Width of the notch in Hz.
+ * \param depth Gain at the center frequency, in [0, 1).
+ * \param sample_rate Sample rate in Hz.
+ */
+CONTROL_TOOLBOX_PUBLIC BiquadCoefficients
+designNotch(double frequency, double width, double depth, double sample_rate);
+
+/*!
+ * \brief Finds the resonance peaks in the magnitude of a frequency response.
+ *
+ * The prominence of a local maximum is its height above the higher of the
+ * two minima found on each side before reaching a higher point.
+ *
+ * \param response Frequency response, with increasing frequencies.
+ * \param min_prominence Minimum prominence in dB for a peak to be reported.
+ * \param max_resonances Maximum number of resonances returned.
+ * \return Resonances sorted by decreasing prominence.
+ */
+CONTROL_TOOLBOX_PUBLIC std::vector<Resonance> detectResonances(
+  const FrequencyResponse & response, double min_prominence, std::size_t max_resonances);
+
+/***************************************************/
+/*! \class NotchFilter
+    \brief Cascade of notch sections with realtime safe coefficient updates
+
+    The sections are evaluated in transposed direct form II. The
+    coefficients are handed to the realtime loop through a realtime
+    buffer, so they can be replaced while the loop is running, e.g.
+    after a new identification. The state of the sections that are
+    kept is preserved, the state of the others is cleared.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC NotchFilter
+{
+public:
+  static constexpr std::size_t MAX_SECTIONS = 8;
+
+  /*!
+   * \brief Store the sections in a struct to allow easier realtime buffer usage
+   */
+  struct Coefficients
+  {
+    std::array<BiquadCoefficients, MAX_SECTIONS> sections; /**< Sections of the cascade. */
+    std::size_t num_sections = 0;                          /**< Number of active sections. */
+    uint64_t revision = 0;                                 /**< Set by setCoefficients. */
+  };
+
+  /*!
+   * \brief Constructor, the filter passes its input through until coefficients are set
+   */
+  NotchFilter();
+
+  /*!
+   * \brief Copy constructor required for preventing mutexes from being copied
+   */
+  NotchFilter(const NotchFilter & source);
+
+  /*!
+   * \brief Set the coefficients of the filter. Not realtime safe.
+   * \return False if there are more than MAX_SECTIONS sections.
+   */
+  bool setCoefficients(const std::vector<BiquadCoefficients> & sections);
+
+  /*!
+   * \brief Filter one sample. Called in RT loop.
+   */
+  double update(double input);
+
+  /*!
+   * \brief Clear the state of all sections
+   */
+  void reset();
+
+private:
+  // Store the coefficients in a realtime buffer to allow updating them without blocking the
+  // realtime update loop
+  realtime_tools::RealtimeBuffer<Coefficients> coefficients_buffer_;
+
+  uint64_t revision_;         /**< Last revision set from non-RT. */
+  uint64_t applied_revision_; /**< Revision used by the RT loop. */
+  std::array<std::array<double, 2>, MAX_SECTIONS> state_; /**< Delay lines of the sections. */
+};
+
+/*!
+ * \brief Designs one notch per resonance, cancelling its prominence.
+ *
+ * Each notch inverts a lightly damped second order mode with the
+ * prominence and -3 dB width of the resonance.
+ *
+ * \param resonances Resonances to suppress, at most NotchFilter::MAX_SECTIONS are used.
+ * \param sample_rate Sample rate of the loop in Hz.
+ * \param width_scale Factor applied to the width of each resonance.
+ */
+CONTROL_TOOLBOX_PUBLIC std::vector<BiquadCoefficients> designNotches(
+  const std::vector<Resonance> & resonances, double sample_rate, double width_scale = 1.0);
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__NOTCH_FILTER_HPP_
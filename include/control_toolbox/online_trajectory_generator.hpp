@@ -0,0 +1,121 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__ONLINE_TRAJECTORY_GENERATOR_HPP_
+#define CONTROL_TOOLBOX__ONLINE_TRAJECTORY_GENERATOR_HPP_
+
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class OnlineTrajectoryGenerator
+    \brief Velocity and acceleration limited tracking of a moving target
+
+    This class replans every cycle toward a target that may change at
+    any time, e.g. a teleoperation setpoint. Assuming the target keeps
+    its velocity, the generator brakes as late as possible and
+    accelerates as much as possible, which is the time optimal
+    trapezoidal profile in discrete time. The state is integrated with
+    semi-implicit Euler:<br>
+
+    \f$v_{k} = v_{k-1} + a_k \Delta t, \quad p_k = p_{k-1} + v_k \Delta t\f$<br>
+
+    and the largest relative velocity that can still be cancelled
+    before reaching the target is computed for this scheme, so the
+    target is reached exactly, without overshoot or chattering.
+
+    Each update is constant time and does not allocate.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC OnlineTrajectoryGenerator
+{
+public:
+  /*!
+   * \brief Constructor, the generator is at rest at position 0
+   */
+  OnlineTrajectoryGenerator();
+
+  /*!
+   * \brief Set the limits of the generated trajectory
+   *
+   * \param max_velocity Velocity limit, > 0.
+   * \param max_acceleration Acceleration limit, > 0.
+   */
+  bool init(double max_velocity, double max_acceleration);
+
+  /*!
+   * \brief Set the state of the generator, e.g. to the measured state
+   */
+  void reset(double position, double velocity = 0.0);
+
+  /*!
+   * \brief Advance the generator by one cycle toward the target
+   *
+   * \param target_position Target position at the end of the cycle
+   * \param target_velocity Target velocity, clamped to the velocity limit
+   * \param dt Duration of the cycle, the state is held if not positive
+   * \param velocity (output) Velocity at the end of the cycle
+   * \param acceleration (output) Acceleration applied during the cycle
+   * \return The position at the end of the cycle
+   */
+  double update(
+    double target_position, double target_velocity, double dt, double & velocity,
+    double & acceleration);
+
+  /*!
+   * \brief Return the current position
+   */
+  double getPosition() const;
+
+  /*!
+   * \brief Return the current velocity
+   */
+  double getVelocity() const;
+
+  /*!
+   * \brief Return the acceleration of the last cycle
+   */
+  double getAcceleration() const;
+
+private:
+  double max_velocity_;     /**< Velocity limit. */
+  double max_acceleration_; /**< Acceleration limit. */
+  double position_;         /**< Current position. */
+  double velocity_;         /**< Current velocity. */
+  double acceleration_;     /**< Acceleration of the last cycle. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__ONLINE_TRAJECTORY_GENERATOR_HPP_
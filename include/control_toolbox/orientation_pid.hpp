@@ -0,0 +1,277 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__ORIENTATION_PID_HPP_
+#define CONTROL_TOOLBOX__ORIENTATION_PID_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "control_toolbox/mimo_pid.hpp"
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+using Vector3 = std::array<double, 3>;
+
+/*!
+ * \brief Unit quaternion representing an orientation
+ */
+struct CONTROL_TOOLBOX_PUBLIC Quaternion
+{
+  double w = 1.0;
+  double x = 0.0;
+  double y = 0.0;
+  double z = 0.0;
+
+  /*!
+   * \brief Hamilton product, applying \c other first
+   */
+  Quaternion operator*(const Quaternion & other) const;
+
+  /*!
+   * \brief Inverse of a unit quaternion
+   */
+  Quaternion conjugate() const;
+
+  /*!
+   * \brief Rotates a vector
+   */
+  Vector3 rotate(const Vector3 & v) const;
+
+  /*!
+   * \brief Rotation vector (axis times angle) of the shortest rotation, angle in [0, pi]
+   */
+  Vector3 log() const;
+
+  /*!
+   * \brief Quaternion of a rotation vector
+   */
+  static Quaternion exp(const Vector3 & rotation);
+};
+
+/***************************************************/
+/*! \class OrientationPid
+    \brief Pid on the orientation error of a rigid body
+
+    The error is the rotation vector of the rotation from the actual
+    to the desired orientation, both expressed in the same (world)
+    frame:<br>
+
+    \f$e = \log(q_d q^{-1})\f$<br>
+
+    and the error derivative is the difference of the angular
+    velocities, expressed in the same frame. Unlike a pid per Euler
+    angle, the error has no singularity and always takes the shortest
+    rotation. The output is a torque, or an angular velocity for a
+    kinematic controller, in the same frame.
+
+    Gains are either one Pid::Gains per axis or full 3 x 3 matrices,
+    see MimoPid. All computations are on fixed size arrays.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC OrientationPid
+{
+public:
+  using Gains = MimoPid<3>::Gains;
+
+  /*!
+   * \brief Set the same gains for the three axes. Not realtime safe.
+   */
+  void setGains(const Pid::Gains & gains);
+
+  /*!
+   * \brief Set one Pid::Gains per axis. Not realtime safe.
+   */
+  void setGains(const std::array<Pid::Gains, 3> & gains);
+
+  /*!
+   * \brief Set 3 x 3 gain matrices. Not realtime safe.
+   */
+  void setGains(const Gains & gains);
+
+  /*!
+   * \brief Get the gains
+   */
+  Gains getGains();
+
+  /*!
+   * \brief Reset the state of the controller
+   */
+  void reset();
+
+  /*!
+   * \brief Compute the command with the angular velocities. Called in RT loop.
+   *
+   * \param desired Desired orientation.
+   * \param actual Actual orientation.
+   * \param desired_velocity Desired angular velocity.
+   * \param actual_velocity Actual angular velocity.
+   * \param dt Change in time since last call in nanoseconds.
+   */
+  Vector3 computeCommand(
+    const Quaternion & desired, const Quaternion & actual, const Vector3 & desired_velocity,
+    const Vector3 & actual_velocity, uint64_t dt);
+
+  /*!
+   * \brief Compute the command, differentiating the orientation error. Called in RT loop.
+   */
+  Vector3 computeCommand(const Quaternion & desired, const Quaternion & actual, uint64_t dt);
+
+  /*!
+   * \brief Return the orientation error of the last update
+   */
+  Vector3 getError() const;
+
+private:
+  MimoPid<3> pid_; /**< Pid on the rotation vector error. */
+};
+
+/***************************************************/
+/*! \class PosePid
+    \brief Pid on the position and orientation error of a rigid body
+
+    The translation uses the position error and the rotation the
+    error of OrientationPid, both in the world frame, so the output is
+    a wrench (force, torque) in that frame. The two parts are tuned
+    independently.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC PosePid
+{
+public:
+  using Vector6 = std::array<double, 6>;
+
+  /*!
+   * \brief Position and orientation of a rigid body
+   */
+  struct Pose
+  {
+    Vector3 position = {0.0, 0.0, 0.0}; /**< Position. */
+    Quaternion orientation;             /**< Orientation. */
+  };
+
+  /*!
+   * \brief Linear and angular velocity of a rigid body
+   */
+  struct Twist
+  {
+    Vector3 linear = {0.0, 0.0, 0.0};  /**< Linear velocity. */
+    Vector3 angular = {0.0, 0.0, 0.0}; /**< Angular velocity. */
+  };
+
+  /*!
+   * \brief Set the gains of the translation and rotation parts. Not realtime safe.
+   */
+  void setGains(const MimoPid<3>::Gains & translation, const OrientationPid::Gains & rotation);
+
+  /*!
+   * \brief Set the same Pid::Gains on the three axes of each part. Not realtime safe.
+   */
+  void setGains(const Pid::Gains & translation, const Pid::Gains & rotation);
+
+  /*!
+   * \brief Reset the state of the controller
+   */
+  void reset();
+
+  /*!
+   * \brief Compute the wrench (force, torque). Called in RT loop.
+   *
+   * \param desired Desired pose.
+   * \param actual Actual pose.
+   * \param desired_twist Desired twist.
+   * \param actual_twist Actual twist.
+   * \param dt Change in time since last call in nanoseconds.
+   */
+  Vector6 computeCommand(
+    const Pose & desired, const Pose & actual, const Twist & desired_twist,
+    const Twist & actual_twist, uint64_t dt);
+
+private:
+  MimoPid<3> translation_;  /**< Pid on the position error. */
+  OrientationPid rotation_; /**< Pid on the orientation error. */
+};
+
+/***************************************************/
+/*! \class PosePidBatch
+    \brief Pose pids of several end effectors updated together
+*/
+/***************************************************/
+
+template <std::size_t K>
+class PosePidBatch
+{
+public:
+  using Poses = std::array<PosePid::Pose, K>;
+  using Twists = std::array<PosePid::Twist, K>;
+  using Wrenches = std::array<PosePid::Vector6, K>;
+
+  /*!
+   * \brief Access the pid of one end effector, e.g. to set its gains
+   */
+  PosePid & operator[](std::size_t k) { return pids_[k]; }
+
+  /*!
+   * \brief Reset the state of all controllers
+   */
+  void reset()
+  {
+    for (auto & pid : pids_) {
+      pid.reset();
+    }
+  }
+
+  /*!
+   * \brief Compute the wrenches of all end effectors. Called in RT loop.
+   */
+  void computeCommands(
+    const Poses & desired, const Poses & actual, const Twists & desired_twists,
+    const Twists & actual_twists, uint64_t dt, Wrenches & wrenches)
+  {
+    for (std::size_t k = 0; k < K; ++k) {
+      wrenches[k] =
+        pids_[k].computeCommand(desired[k], actual[k], desired_twists[k], actual_twists[k], dt);
+    }
+  }
+
+private:
+  std::array<PosePid, K> pids_; /**< One pid per end effector. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__ORIENTATION_PID_HPP_
@@ -33,7 +33,10 @@
 #ifndef CONTROL_TOOLBOX__PID_HPP_
 #define CONTROL_TOOLBOX__PID_HPP_
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "rclcpp/clock.hpp"
@@ -43,10 +46,13 @@
 #include "realtime_tools/realtime_buffer.h"
 #include "realtime_tools/realtime_publisher.h"
 
+#include "control_toolbox/gain_curve.hpp"
 #include "control_toolbox/visibility_control.hpp"
 
 namespace control_toolbox
 {
+class GainSchedule;
+
 /***************************************************/
 /*! \class Pid
   \brief A basic pid class.
@@ -114,17 +120,18 @@ public:
   struct Gains
   {
     // Optional constructor for passing in values without antiwindup
-    Gains(double p, double i, double d, double i_max, double i_min)
+    constexpr Gains(double p, double i, double d, double i_max, double i_min)
     : p_gain_(p), i_gain_(i), d_gain_(d), i_max_(i_max), i_min_(i_min), antiwindup_(false)
     {
     }
     // Optional constructor for passing in values
-    Gains(double p, double i, double d, double i_max, double i_min, bool antiwindup)
+    constexpr Gains(double p, double i, double d, double i_max, double i_min, bool antiwindup)
     : p_gain_(p), i_gain_(i), d_gain_(d), i_max_(i_max), i_min_(i_min), antiwindup_(antiwindup)
     {
     }
     // Default constructor
-    Gains() : p_gain_(0.0), i_gain_(0.0), d_gain_(0.0), i_max_(0.0), i_min_(0.0), antiwindup_(false)
+    constexpr Gains()
+    : p_gain_(0.0), i_gain_(0.0), d_gain_(0.0), i_max_(0.0), i_min_(0.0), antiwindup_(false)
     {
     }
     double p_gain_;   /**< Proportional gain. */
@@ -180,6 +187,11 @@ public:
 
   /*!
    * \brief Get PID gains for the controller.
+   *
+   * These are the gains set with setGains(). The gains applied by
+   * computeCommand differ during a ramp, with a gain schedule or a gain
+   * curve, see getActiveGains().
+   *
    * \param p The proportional gain.
    * \param i The integral gain.
    * \param d The derivative gain.
@@ -191,11 +203,22 @@ public:
     double & p, double & i, double & d, double & i_max, double & i_min, bool & antiwindup);
 
   /*!
-   * \brief Get PID gains for the controller.
+   * \brief Get PID gains for the controller, as set with setGains().
    * \return gains A struct of the PID gain values
    */
   Gains getGains();
 
+  /*!
+   * \brief Get PID gains for the controller from a non realtime thread.
+   *
+   * Unlike getGains(), which is meant for the thread computing the
+   * commands, this can be called from any number of other threads while
+   * the commands are computed. Not realtime safe.
+   *
+   * \return gains A struct of the PID gain values
+   */
+  Gains getGainsNonRT();
+
   /*!
    * \brief Set PID gains for the controller.
    * \param p The proportional gain.
@@ -212,6 +235,76 @@ public:
    */
   void setGains(const Gains & gains);
 
+  /*!
+   * \brief Set the number of cycles over which new gains are applied.
+   *
+   * When new gains are set, the gains used by computeCommand move linearly
+   * from the active gains to the new ones over \c cycles calls, which
+   * avoids a step in the command after a large change of the P or D gain.
+   * While ramping, the integral error is rescaled as the integral gain
+   * changes, so the integral term stays continuous.
+   *
+   * A ramp also starts when a gain schedule is set or removed. Within a
+   * schedule, the gains follow the scheduling variable without a ramp.
+   *
+   * \param cycles Number of cycles of the ramp, 0 applies new gains at once (default).
+   */
+  void setGainRampCycles(unsigned int cycles);
+
+  /*!
+   * \brief Get the number of cycles over which new gains are applied.
+   */
+  unsigned int getGainRampCycles() const;
+
+  /*!
+   * \brief Set a curve scaling the proportional gain with the error magnitude.
+   *
+   * The proportional term becomes \f$p_{gain} s(|p_{error}|) p_{error}\f$.
+   * The curve is immutable and handed to the realtime loop as a pointer,
+   * so it can be replaced while the loop is running. Not realtime safe.
+   *
+   * \param curve The curve, nullptr to disable the scaling (default).
+   */
+  void setGainCurve(std::shared_ptr<const GainCurve> curve);
+
+  /*!
+   * \brief Get the curve scaling the proportional gain. Not realtime safe.
+   */
+  std::shared_ptr<const GainCurve> getGainCurve();
+
+  /*!
+   * \brief Set a schedule giving the gains as a function of a scheduling variable.
+   *
+   * While a schedule with gains is set, computeCommand uses the gains of the
+   * schedule at the value given to setScheduleVariable() instead of the gains
+   * set with setGains(). The schedule is immutable and handed to the realtime
+   * loop as a pointer, so it can be replaced while the loop is running. Not
+   * realtime safe.
+   *
+   * \param schedule The schedule, nullptr to use the gains set with setGains() (default).
+   */
+  void setGainSchedule(std::shared_ptr<const GainSchedule> schedule);
+
+  /*!
+   * \brief Get the gain schedule. Not realtime safe.
+   */
+  std::shared_ptr<const GainSchedule> getGainSchedule();
+
+  /*!
+   * \brief Set the scheduling variable used by the next calls to computeCommand.
+   *        Call it from the thread computing the commands.
+   */
+  void setScheduleVariable(double value);
+
+  /*!
+   * \brief Get the gains applied by the last call to computeCommand.
+   *
+   * These are the gains set or those of the gain schedule, during a ramp
+   * the ramped ones, with the proportional gain scaled by the gain curve.
+   * Call it from the thread computing the commands.
+   */
+  Gains getActiveGains() const;
+
   /*!
    * \brief Set the PID error and compute the PID command with nonuniform time
    * step size. The derivative error is computed from the change in the error
@@ -254,6 +347,10 @@ public:
 
   /*!
    * \brief Return PID error terms for the controller.
+   *
+   * The state getters can be called from other threads while the commands
+   * are computed, the three errors always come from the same update.
+   *
    * \param pe  The proportional error.
    * \param ie  The integral error.
    * \param de  The derivative error.
@@ -272,6 +369,12 @@ public:
 
     // Copy the realtime buffer to then new PID class
     gains_buffer_ = source.gains_buffer_;
+    gain_curve_buffer_ = source.gain_curve_buffer_;
+    gain_schedule_buffer_ = source.gain_schedule_buffer_;
+    has_gain_curve_ = source.has_gain_curve_.load();
+    has_gain_schedule_ = source.has_gain_schedule_.load();
+    ramp_cycles_ = source.ramp_cycles_.load();
+    schedule_variable_ = source.schedule_variable_;
 
     // Reset the state of this PID controller
     reset();
@@ -284,12 +387,49 @@ protected:
   // blocking the realtime update loop
   realtime_tools::RealtimeBuffer<Gains> gains_buffer_;
 
+  // Same for the gain curve and the gain schedule, the old ones are released when the next ones
+  // are written
+  realtime_tools::RealtimeBuffer<std::shared_ptr<const GainCurve>> gain_curve_buffer_;
+  realtime_tools::RealtimeBuffer<std::shared_ptr<const GainSchedule>> gain_schedule_buffer_;
+
+  // Set while a gain curve or a gain schedule is set, so that the realtime loop of a Pid using
+  // neither skips the lookups of their buffers
+  std::atomic<bool> has_gain_curve_;
+  std::atomic<bool> has_gain_schedule_;
+  double schedule_variable_; /**< Value at which the gain schedule is evaluated. */
+
   double p_error_last_; /**< _Save position state for derivative state calculation. */
   double p_error_;      /**< Position error. */
   double i_error_;      /**< Integral of position error. */
   double d_error_;      /**< Derivative of position error. */
   double cmd_;          /**< Command to send. */
   double error_dot_;    /**< Derivative error */
+
+  std::atomic<unsigned int> ramp_cycles_; /**< Cycles over which new gains are applied. */
+  Gains target_gains_;                    /**< Last gains read from the realtime buffer. */
+  Gains active_gains_;                    /**< Gains after the schedule and the ramp. */
+  Gains applied_gains_;                   /**< Active gains scaled by the gain curve. */
+  const GainSchedule * active_schedule_;  /**< Schedule the active gains come from. */
+  unsigned int ramp_remaining_;           /**< Cycles left in the ramp. */
+
+private:
+  const GainSchedule * readGainSchedule();
+  const Gains & updateActiveGains();
+
+  // Index of the values in published_state_
+  enum StateIndex { P_ERROR, I_ERROR, D_ERROR, CMD, ERROR_DOT, STATE_SIZE };
+
+  void publishState();
+  std::array<double, STATE_SIZE> readState() const;
+
+  // The state of the last update is copied for the getters, guarded by a sequence lock: the
+  // sequence is odd while the realtime thread writes the values, readers retry until they see
+  // the same even sequence before and after reading them
+  std::atomic<uint32_t> state_sequence_;
+  std::array<std::atomic<double>, STATE_SIZE> published_state_;
+
+  // Serializes the non realtime accesses to the realtime buffers
+  std::mutex non_rt_mutex_;
 };
 
 }  // namespace control_toolbox
@@ -0,0 +1,230 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__PID_BANK_HPP_
+#define CONTROL_TOOLBOX__PID_BANK_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "realtime_tools/realtime_buffer.h"
+
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class PidBank
+    \brief A bank of independent pid channels updated together
+
+    This class runs many pid loops with the same equations as Pid,
+    keeping the state of all channels in contiguous arrays.
+
+    Slow channels can be evaluated on events only: a channel is
+    recomputed when its error moved by more than a threshold since its
+    last evaluation, or when a maximum interval elapsed. Otherwise its
+    last command is held. On evaluation, the derivative is taken over
+    the whole interval since the last evaluation, and the integral
+    covers that interval too: the cycles during which the command was
+    held are integrated with the last evaluated error, the remaining
+    ones with the current error. This is an approximation, as the held
+    errors were not integrated individually. Each of them was within
+    the threshold of the last evaluated error, otherwise it would have
+    triggered an evaluation, so the integral error of the channel is
+    off by at most the threshold times the held time, which is bounded
+    by the maximum interval when one is set. Before the integral clamp,
+    the integral term is thus off by at most
+    \f$|K_i| \cdot threshold \cdot max\_interval\f$ per evaluation.
+
+    Channels can also run at a fraction of the rate of the bank, set by
+    an integer divider. The cycle of each channel within its period is
+    chosen to spread the evaluations evenly over the cycles, so the
+    worst case time of a cycle is set by its most loaded slot rather
+    than by all the channels. The integral and derivative use the time
+    elapsed since the last evaluation of the channel.
+
+    Each cycle, the due and triggered channels are first gathered into a
+    compacted list, then only the channels of this list are computed.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC PidBank
+{
+public:
+  static constexpr uint64_t MAX_HYPERPERIOD = 1 << 16;
+
+  /*!
+   * \brief Store the rate dividers in a struct to allow easier realtime buffer usage
+   */
+  struct Schedule
+  {
+    std::vector<unsigned int> dividers; /**< Rate divider of each channel, empty if all 1. */
+    std::vector<unsigned int> phases;   /**< Cycle of each channel within its period. */
+    std::size_t max_slot_load = 0;      /**< Largest number of channels due in a cycle. */
+  };
+
+  /*!
+   * \brief Store the event trigger settings in a struct to allow easier realtime buffer usage
+   */
+  struct EventTrigger
+  {
+    double error_threshold = 0.0; /**< Error change that triggers an evaluation. */
+    uint64_t max_interval = 0;    /**< Maximum time between evaluations in nanoseconds. */
+  };
+
+  /*!
+   * \brief Constructor, the bank has no channel until initialized
+   */
+  PidBank();
+
+  /*!
+   * \brief Allocates the channels and sets their gains. Not realtime safe.
+   *
+   * \param num_channels Number of channels.
+   * \param gains Gains of all channels.
+   */
+  bool init(std::size_t num_channels, const Pid::Gains & gains);
+
+  /*!
+   * \brief Set the gains of all channels. Not realtime safe.
+   * \return False if the number of gains differs from the number of channels.
+   */
+  bool setGains(const std::vector<Pid::Gains> & gains);
+
+  /*!
+   * \brief Get the gains of all channels, as set with setGains(). Not realtime safe.
+   */
+  std::vector<Pid::Gains> getGains();
+
+  /*!
+   * \brief Enable evaluation on events. Not realtime safe.
+   *
+   * The settings are handed to the realtime loop through a realtime buffer, so they can be
+   * changed while the loop is running.
+   *
+   * \param error_threshold Change of the error since the last evaluation that triggers an
+   *        evaluation.
+   * \param max_interval Maximum time between two evaluations in nanoseconds, 0 evaluates every
+   *        cycle (default).
+   */
+  bool setEventTrigger(double error_threshold, uint64_t max_interval);
+
+  /*!
+   * \brief Set the rate of each channel as a divider of the rate of the bank. Not realtime safe.
+   *
+   * A channel with divider n is evaluated once every n cycles. The cycles
+   * are assigned to balance the number of channels evaluated per cycle
+   * over the least common multiple of the dividers.
+   *
+   * \param dividers Divider of each channel, at least 1.
+   * \return False if a divider is 0, the number of dividers is wrong or the least common
+   *         multiple of the dividers exceeds MAX_HYPERPERIOD.
+   */
+  bool setRateDividers(const std::vector<unsigned int> & dividers);
+
+  /*!
+   * \brief Return the largest number of channels scheduled in a cycle, before event triggering.
+   */
+  std::size_t getMaxSlotLoad() const;
+
+  /*!
+   * \brief Reset the state of all channels
+   */
+  void reset();
+
+  /*!
+   * \brief Update the command of all channels. Called in RT loop.
+   *
+   * \param errors Error of each channel, since last call (error = target - state).
+   * \param dt Change in time since last call in nanoseconds.
+   * \param commands (output) Command of each channel, resized to the number of channels.
+   * \return False if the number of errors is wrong or dt is 0.
+   */
+  bool computeCommands(
+    const std::vector<double> & errors, uint64_t dt, std::vector<double> & commands);
+
+  /*!
+   * \brief Return the channels evaluated during the last update
+   */
+  const std::vector<std::size_t> & getActiveChannels() const;
+
+  /*!
+   * \brief Return PID error terms of a channel, as of its last evaluation.
+   */
+  void getCurrentPIDErrors(std::size_t channel, double & pe, double & ie, double & de) const;
+
+  /*!
+   * \brief Return the fraction of due channel updates skipped by the event trigger since the
+   *        last reset
+   */
+  double getSkipRatio() const;
+
+  /*!
+   * \brief Return the number of channels
+   */
+  std::size_t size() const;
+
+protected:
+  // Store the PID gains in a realtime buffer to allow updating them without blocking the
+  // realtime update loop
+  realtime_tools::RealtimeBuffer<std::vector<Pid::Gains>> gains_buffer_;
+
+  // Same for the rate dividers
+  realtime_tools::RealtimeBuffer<Schedule> schedule_buffer_;
+  std::size_t max_slot_load_; /**< Largest slot load of the last schedule set. */
+
+  // Same for the event trigger settings
+  realtime_tools::RealtimeBuffer<EventTrigger> trigger_buffer_;
+
+  std::vector<double> p_error_;   /**< Position error at the last evaluation. */
+  std::vector<double> i_error_;   /**< Integral of position error. */
+  std::vector<double> d_error_;   /**< Derivative of position error. */
+  std::vector<double> cmd_;       /**< Command at the last evaluation. */
+  std::vector<uint64_t> elapsed_; /**< Time since the last evaluation in nanoseconds. */
+  std::vector<uint64_t> held_;    /**< Part of elapsed_ skipped by the event trigger. */
+  std::vector<bool> evaluated_;   /**< True once the channel was evaluated. */
+
+  std::vector<std::size_t> active_; /**< Channels evaluated during the last update. */
+  uint64_t cycle_;                  /**< Cycles since the last reset. */
+  uint64_t num_evaluations_;        /**< Channel evaluations since the last reset. */
+  uint64_t num_skips_;              /**< Channel updates skipped since the last reset. */
+
+  // Serializes the non realtime accesses to the realtime buffers
+  std::mutex non_rt_mutex_;
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__PID_BANK_HPP_
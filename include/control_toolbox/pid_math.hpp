@@ -0,0 +1,143 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__PID_MATH_HPP_
+#define CONTROL_TOOLBOX__PID_MATH_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "control_toolbox/pid.hpp"
+
+namespace control_toolbox
+{
+/*!
+ * \brief The update of Pid::computeCommand, as constexpr functions
+ *
+ * These are the reference of all the Pid implementations of the package:
+ * Pid and PidBank compute their commands with them, and they can be
+ * checked against reference vectors at compile time.
+ */
+namespace pid_math
+{
+/*!
+ * \brief Result of one update
+ */
+struct Step
+{
+  double i_error; /**< Integral of the error after the update. */
+  double command; /**< Command of the update. */
+};
+
+/*!
+ * \brief Clamps \c value to [low, high], constexpr unlike filters::clamp
+ */
+template <typename T>
+constexpr T clamp(T value, T low, T high)
+{
+  if (value < low) {
+    return low;
+  } else if (value > high) {
+    return high;
+  }
+  return value;
+}
+
+/*!
+ * \brief Integrates \c error over \c dt nanoseconds, with the forward Euler scheme
+ */
+constexpr double integrate(double i_error, double error, uint64_t dt)
+{
+  return i_error + (dt / 1e9) * error;
+}
+
+/*!
+ * \brief Differentiates the error with a backward difference over \c dt nanoseconds
+ */
+constexpr double differentiate(double error, double last_error, uint64_t dt)
+{
+  return (error - last_error) / (dt / 1e9);
+}
+
+/*!
+ * \brief Limits the integral of the error so the integral term stays within its bounds
+ *
+ * Only applied with antiwindup and a non zero integral gain.
+ */
+constexpr double limitIntegralError(const Pid::Gains & gains, double i_error)
+{
+  if (gains.antiwindup_ && gains.i_gain_ != 0) {
+    const std::pair<double, double> bounds =
+      std::minmax<double>(gains.i_min_ / gains.i_gain_, gains.i_max_ / gains.i_gain_);
+    return clamp(i_error, bounds.first, bounds.second);
+  }
+  return i_error;
+}
+
+/*!
+ * \brief Integral term, clamped to [i_min, i_max] without antiwindup
+ */
+constexpr double integralTerm(const Pid::Gains & gains, double i_error)
+{
+  const double i_term = gains.i_gain_ * i_error;
+  return gains.antiwindup_ ? i_term : clamp(i_term, gains.i_min_, gains.i_max_);
+}
+
+/*!
+ * \brief Sum of the proportional, integral and derivative terms
+ */
+constexpr double command(const Pid::Gains & gains, double error, double i_term, double error_dot)
+{
+  return gains.p_gain_ * error + i_term + gains.d_gain_ * error_dot;
+}
+
+/*!
+ * \brief One update of a Pid
+ *
+ * \param gains Gains of the update.
+ * \param i_error Integral of the error before the update.
+ * \param error Error since last call (error = target - state).
+ * \param error_dot Derivative of the error.
+ * \param dt Change in time since last call in nanoseconds.
+ */
+constexpr Step computeStep(
+  const Pid::Gains & gains, double i_error, double error, double error_dot, uint64_t dt)
+{
+  const double integral = limitIntegralError(gains, integrate(i_error, error, dt));
+  return {integral, command(gains, error, integralTerm(gains, integral), error_dot)};
+}
+
+}  // namespace pid_math
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__PID_MATH_HPP_
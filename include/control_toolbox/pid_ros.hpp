@@ -33,6 +33,8 @@
 #ifndef CONTROL_TOOLBOX__PID_ROS_HPP_
 #define CONTROL_TOOLBOX__PID_ROS_HPP_
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -46,6 +48,7 @@
 #include "realtime_tools/realtime_publisher.h"
 
 #include "control_toolbox/pid.hpp"
+#include "control_toolbox/telemetry.hpp"
 #include "control_toolbox/visibility_control.hpp"
 
 namespace control_toolbox
@@ -54,6 +57,8 @@ namespace control_toolbox
 class CONTROL_TOOLBOX_PUBLIC PidROS
 {
 public:
+  using StateCallback = std::function<void(const control_msgs::msg::PidState &)>;
+
   /*!
    * \brief Constructor of PidROS class.
    *
@@ -187,6 +192,54 @@ public:
    */
   void printValues();
 
+  /*!
+   * \brief Export the state of every cycle to a shared memory telemetry ring
+   *
+   * The ring holds the fields of the PidState message and can be read by
+   * other processes with TelemetryReader, e.g. with the telemetry_scope
+   * tool. The records are stamped with the same clock as the state
+   * messages, see setClock(). The ring is handed to the realtime loop as a
+   * pointer, so telemetry can be enabled while the loop is running. Not
+   * realtime safe.
+   *
+   * \param name Name of the shared memory object, e.g. "/joint1_pid".
+   * \param capacity Number of cycles kept in the ring.
+   * \return False if the ring could not be created.
+   */
+  bool enableTelemetry(const std::string & name, std::size_t capacity = 4096);
+
+  /*!
+   * \brief Stop the telemetry export. Not realtime safe.
+   *
+   * The ring is removed outside the realtime loop, once the loop stopped
+   * using it, when telemetry is enabled again or this object is destroyed.
+   */
+  void disableTelemetry();
+
+  /*!
+   * \brief Set the clock used to stamp the state messages
+   *
+   * E.g. a clock with a time override, to run with simulated time. The
+   * clock is handed to the realtime loop through a realtime buffer, so it
+   * can be set while the loop is running. Not realtime safe.
+   *
+   * \param clock The clock, nullptr for the system clock (default).
+   */
+  void setClock(rclcpp::Clock::SharedPtr clock);
+
+  /*!
+   * \brief Hand the state of every cycle to a callback instead of publishing it
+   *
+   * The callback is called from computeCommand, in the calling thread, so
+   * the states are captured deterministically and without a round trip
+   * through the middleware, e.g. in tests. Like the clock, the callback is
+   * handed to the realtime loop through a realtime buffer. Not realtime
+   * safe.
+   *
+   * \param callback The callback, an empty function to publish the states again.
+   */
+  void setStateCallback(StateCallback callback);
+
   /*!
    * \brief Return PID parameters callback handle
    * \return shared_ptr to the PID parameters callback handle
@@ -220,6 +273,16 @@ private:
   std::shared_ptr<realtime_tools::RealtimePublisher<control_msgs::msg::PidState>> rt_state_pub_;
   std::shared_ptr<rclcpp::Publisher<control_msgs::msg::PidState>> state_pub_;
 
+  // Telemetry ring handed to the realtime loop, the old ring is released when the next one is
+  // written, outside the realtime loop
+  realtime_tools::RealtimeBuffer<std::shared_ptr<TelemetryWriter>> telemetry_buffer_;
+
+  // Clock and state callback handed to the realtime loop
+  rclcpp::Clock::SharedPtr system_clock_;
+  realtime_tools::RealtimeBuffer<rclcpp::Clock::SharedPtr> clock_buffer_;
+  realtime_tools::RealtimeBuffer<StateCallback> state_callback_buffer_;
+  control_msgs::msg::PidState state_msg_;
+
   Pid pid_;
   std::string topic_prefix_;
   std::string param_prefix_;
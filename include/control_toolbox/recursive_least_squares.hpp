@@ -0,0 +1,446 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__RECURSIVE_LEAST_SQUARES_HPP_
+#define CONTROL_TOOLBOX__RECURSIVE_LEAST_SQUARES_HPP_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class RecursiveLeastSquares
+    \brief Fixed size recursive least squares estimator
+
+    Estimates the parameters \f$\theta\f$ of the linear model
+    \f$y = \varphi^T \theta\f$ from a stream of regressors
+    \f$\varphi\f$ and measurements \f$y\f$, with exponential forgetting:<br>
+
+    \f$K = \frac{P \varphi}{\lambda + \varphi^T P \varphi}\f$<br>
+    \f$\theta \leftarrow \theta + K (y - \varphi^T \theta)\f$<br>
+    \f$P \leftarrow (P - K \varphi^T P) / \lambda\f$<br>
+
+    The covariance \f$P\f$ is reset to \f$p_0 I\f$ when its trace
+    leaves the configured range: a small trace means the estimator
+    stopped adapting, a large one that forgetting without excitation
+    is winding it up.
+
+    The dimension is a template parameter, all storage is inline and
+    the loops have compile time bounds, so an update allocates nothing
+    and can be unrolled by the compiler.
+*/
+/***************************************************/
+
+template <std::size_t N>
+class RecursiveLeastSquares
+{
+public:
+  using Vector = std::array<double, N>;
+  using Matrix = std::array<double, N * N>;
+
+  RecursiveLeastSquares()
+  : theta_(),
+    covariance_(),
+    forgetting_factor_(1.0),
+    initial_covariance_(1e3),
+    min_trace_(0.0),
+    max_trace_(std::numeric_limits<double>::infinity()),
+    num_resets_(0)
+  {
+    resetCovariance();
+  }
+
+  /*!
+   * \brief Configure the estimator and reset the parameters to zero
+   *
+   * \param forgetting_factor Forgetting factor \f$\lambda\f$, in (0, 1].
+   * \param initial_covariance Diagonal \f$p_0\f$ of the covariance after a reset, > 0.
+   * \param min_trace The covariance is reset when its trace drops below this value.
+   * \param max_trace The covariance is reset when its trace grows above this value.
+   */
+  bool init(
+    double forgetting_factor, double initial_covariance, double min_trace = 0.0,
+    double max_trace = std::numeric_limits<double>::infinity())
+  {
+    if (
+      forgetting_factor <= 0.0 || forgetting_factor > 1.0 || initial_covariance <= 0.0 ||
+      min_trace > max_trace) {
+      return false;
+    }
+    forgetting_factor_ = forgetting_factor;
+    initial_covariance_ = initial_covariance;
+    min_trace_ = min_trace;
+    max_trace_ = max_trace;
+    theta_.fill(0.0);
+    num_resets_ = 0;
+    resetCovariance();
+    return true;
+  }
+
+  /*!
+   * \brief Update the estimate with a new measurement. Called in RT loop.
+   *
+   * \param regressor Regressor \f$\varphi\f$.
+   * \param measurement Measurement \f$y\f$.
+   * \return The a priori prediction error \f$y - \varphi^T \theta\f$.
+   */
+  double update(const Vector & regressor, double measurement)
+  {
+    Vector p_phi;
+    double denominator = forgetting_factor_;
+    double error = measurement;
+    for (std::size_t i = 0; i < N; ++i) {
+      double sum = 0.0;
+      for (std::size_t j = 0; j < N; ++j) {
+        sum += covariance_[i * N + j] * regressor[j];
+      }
+      p_phi[i] = sum;
+      denominator += regressor[i] * sum;
+      error -= regressor[i] * theta_[i];
+    }
+    if (!std::isfinite(error) || !std::isfinite(denominator) || denominator <= 0.0) {
+      return 0.0;
+    }
+
+    const double inverse_denominator = 1.0 / denominator;
+    const double inverse_lambda = 1.0 / forgetting_factor_;
+    double trace = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+      const double gain = p_phi[i] * inverse_denominator;
+      theta_[i] += gain * error;
+      // Only compute the upper triangle and mirror it to keep P symmetric
+      for (std::size_t j = i; j < N; ++j) {
+        const double value = (covariance_[i * N + j] - gain * p_phi[j]) * inverse_lambda;
+        covariance_[i * N + j] = value;
+        covariance_[j * N + i] = value;
+      }
+      trace += covariance_[i * N + i];
+    }
+
+    if (trace < min_trace_ || trace > max_trace_) {
+      resetCovariance();
+      ++num_resets_;
+    }
+
+    return error;
+  }
+
+  /*!
+   * \brief Predict the measurement for the given regressor
+   */
+  double predict(const Vector & regressor) const
+  {
+    double prediction = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+      prediction += regressor[i] * theta_[i];
+    }
+    return prediction;
+  }
+
+  /*!
+   * \brief Reset the covariance to its initial value, keeping the parameters
+   */
+  void resetCovariance()
+  {
+    covariance_.fill(0.0);
+    for (std::size_t i = 0; i < N; ++i) {
+      covariance_[i * N + i] = initial_covariance_;
+    }
+  }
+
+  /*!
+   * \brief Return the estimated parameters
+   */
+  const Vector & getParameters() const { return theta_; }
+
+  /*!
+   * \brief Set the parameters, e.g. to start from a previous identification
+   */
+  void setParameters(const Vector & theta) { theta_ = theta; }
+
+  /*!
+   * \brief Return the covariance, row major
+   */
+  const Matrix & getCovariance() const { return covariance_; }
+
+  /*!
+   * \brief Return the number of covariance resets triggered by the trace bounds
+   */
+  std::size_t getNumResets() const { return num_resets_; }
+
+private:
+  Vector theta_;              /**< Estimated parameters. */
+  Matrix covariance_;         /**< Covariance, row major. */
+  double forgetting_factor_;  /**< Forgetting factor. */
+  double initial_covariance_; /**< Diagonal of the covariance after a reset. */
+  double min_trace_;          /**< Lower bound of the covariance trace. */
+  double max_trace_;          /**< Upper bound of the covariance trace. */
+  std::size_t num_resets_;    /**< Number of covariance resets. */
+};
+
+/***************************************************/
+/*! \class ArxEstimator
+    \brief Recursive identification of an ARX plant model
+
+    Estimates the coefficients of<br>
+
+    \f$y(k) = -a_1 y(k-1) - \dots - a_{n_a} y(k-n_a) + b_1 u(k-1) + \dots + b_{n_b} u(k-n_b)\f$<br>
+
+    The parameter vector is \f$[a_1, \dots, a_{n_a}, b_1, \dots, b_{n_b}]\f$.
+*/
+/***************************************************/
+
+template <std::size_t NA, std::size_t NB>
+class ArxEstimator
+{
+public:
+  using Estimator = RecursiveLeastSquares<NA + NB>;
+
+  ArxEstimator() : regressor_() {}
+
+  /*!
+   * \brief Configure the estimator, see RecursiveLeastSquares::init()
+   */
+  bool init(
+    double forgetting_factor, double initial_covariance, double min_trace = 0.0,
+    double max_trace = std::numeric_limits<double>::infinity())
+  {
+    regressor_.fill(0.0);
+    return estimator_.init(forgetting_factor, initial_covariance, min_trace, max_trace);
+  }
+
+  /*!
+   * \brief Update with the input applied at the previous sample and the current output.
+   *
+   * \param input Input \f$u(k-1)\f$.
+   * \param output Output \f$y(k)\f$.
+   * \return The a priori prediction error.
+   */
+  double update(double input, double output)
+  {
+    shift(NA, NB, input);
+    double error = estimator_.update(regressor_, output);
+    shift(0, NA, -output);
+    return error;
+  }
+
+  /*!
+   * \brief Return the underlying estimator
+   */
+  const Estimator & getEstimator() const { return estimator_; }
+
+  /*!
+   * \brief Return the coefficient \f$a_i\f$, with i in [1, NA]
+   */
+  double getA(std::size_t i) const { return estimator_.getParameters()[i - 1]; }
+
+  /*!
+   * \brief Return the coefficient \f$b_i\f$, with i in [1, NB]
+   */
+  double getB(std::size_t i) const { return estimator_.getParameters()[NA + i - 1]; }
+
+private:
+  // Shift the regressor entries in [begin, begin + size) and insert value in front
+  void shift(std::size_t begin, std::size_t size, double value)
+  {
+    if (size == 0) {
+      return;
+    }
+    for (std::size_t i = begin + size - 1; i > begin; --i) {
+      regressor_[i] = regressor_[i - 1];
+    }
+    regressor_[begin] = value;
+  }
+
+  Estimator estimator_;
+  typename Estimator::Vector regressor_;
+};
+
+/***************************************************/
+/*! \class RecursiveLeastSquaresBank
+    \brief Several recursive least squares estimators updated together
+
+    Runs C independent estimators of dimension N, e.g. one per joint,
+    with the same settings. The state is stored channel-last
+    (structure of arrays) so the inner loops run over the channels with
+    unit stride and can be vectorized. Regressors are passed the same
+    way, \c regressors[i][c] is the entry i of the regressor of channel c.
+*/
+/***************************************************/
+
+template <std::size_t N, std::size_t C>
+class RecursiveLeastSquaresBank
+{
+public:
+  using ChannelVector = std::array<double, C>;
+  using Regressors = std::array<ChannelVector, N>;
+
+  RecursiveLeastSquaresBank()
+  : theta_(),
+    covariance_(),
+    forgetting_factor_(1.0),
+    initial_covariance_(1e3),
+    min_trace_(0.0),
+    max_trace_(std::numeric_limits<double>::infinity())
+  {
+    for (std::size_t c = 0; c < C; ++c) {
+      resetCovariance(c);
+    }
+  }
+
+  /*!
+   * \brief Configure all estimators, see RecursiveLeastSquares::init()
+   */
+  bool init(
+    double forgetting_factor, double initial_covariance, double min_trace = 0.0,
+    double max_trace = std::numeric_limits<double>::infinity())
+  {
+    if (
+      forgetting_factor <= 0.0 || forgetting_factor > 1.0 || initial_covariance <= 0.0 ||
+      min_trace > max_trace) {
+      return false;
+    }
+    forgetting_factor_ = forgetting_factor;
+    initial_covariance_ = initial_covariance;
+    min_trace_ = min_trace;
+    max_trace_ = max_trace;
+    for (auto & row : theta_) {
+      row.fill(0.0);
+    }
+    for (std::size_t c = 0; c < C; ++c) {
+      resetCovariance(c);
+    }
+    return true;
+  }
+
+  /*!
+   * \brief Update all estimators with a new measurement each. Called in RT loop.
+   *
+   * \param regressors Regressors, \c regressors[i][c] for entry i of channel c.
+   * \param measurements Measurement of each channel.
+   * \param errors (output) A priori prediction error of each channel.
+   */
+  void update(
+    const Regressors & regressors, const ChannelVector & measurements, ChannelVector & errors)
+  {
+    Regressors p_phi;
+    ChannelVector denominator;
+    denominator.fill(forgetting_factor_);
+    errors = measurements;
+
+    for (std::size_t i = 0; i < N; ++i) {
+      p_phi[i].fill(0.0);
+      for (std::size_t j = 0; j < N; ++j) {
+        const ChannelVector & p = covariance_[i * N + j];
+        for (std::size_t c = 0; c < C; ++c) {
+          p_phi[i][c] += p[c] * regressors[j][c];
+        }
+      }
+      for (std::size_t c = 0; c < C; ++c) {
+        denominator[c] += regressors[i][c] * p_phi[i][c];
+        errors[c] -= regressors[i][c] * theta_[i][c];
+      }
+    }
+
+    // Channels with invalid data are left untouched: their updates are computed with the
+    // others but not stored, as the products with a regressor that is not finite are not finite
+    std::array<bool, C> valid;
+    ChannelVector inverse_denominator;
+    for (std::size_t c = 0; c < C; ++c) {
+      valid[c] =
+        std::isfinite(errors[c]) && std::isfinite(denominator[c]) && denominator[c] > 0.0;
+      inverse_denominator[c] = valid[c] ? 1.0 / denominator[c] : 0.0;
+      errors[c] = valid[c] ? errors[c] : 0.0;
+    }
+
+    const double inverse_lambda = 1.0 / forgetting_factor_;
+    ChannelVector trace;
+    trace.fill(0.0);
+    for (std::size_t i = 0; i < N; ++i) {
+      ChannelVector gain;
+      for (std::size_t c = 0; c < C; ++c) {
+        gain[c] = p_phi[i][c] * inverse_denominator[c];
+        const double theta = theta_[i][c] + gain[c] * errors[c];
+        theta_[i][c] = valid[c] ? theta : theta_[i][c];
+      }
+      for (std::size_t j = i; j < N; ++j) {
+        ChannelVector & upper = covariance_[i * N + j];
+        for (std::size_t c = 0; c < C; ++c) {
+          const double updated = (upper[c] - gain[c] * p_phi[j][c]) * inverse_lambda;
+          upper[c] = valid[c] ? updated : upper[c];
+        }
+        covariance_[j * N + i] = upper;
+      }
+      for (std::size_t c = 0; c < C; ++c) {
+        trace[c] += covariance_[i * N + i][c];
+      }
+    }
+
+    for (std::size_t c = 0; c < C; ++c) {
+      if (trace[c] < min_trace_ || trace[c] > max_trace_) {
+        resetCovariance(c);
+      }
+    }
+  }
+
+  /*!
+   * \brief Reset the covariance of one channel to its initial value
+   */
+  void resetCovariance(std::size_t channel)
+  {
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        covariance_[i * N + j][channel] = (i == j) ? initial_covariance_ : 0.0;
+      }
+    }
+  }
+
+  /*!
+   * \brief Return the parameter i of the given channel
+   */
+  double getParameter(std::size_t channel, std::size_t i) const { return theta_[i][channel]; }
+
+private:
+  Regressors theta_;                            /**< Parameters, channel last. */
+  std::array<ChannelVector, N * N> covariance_; /**< Covariances, channel last. */
+  double forgetting_factor_;                    /**< Forgetting factor. */
+  double initial_covariance_; /**< Diagonal of the covariance after a reset. */
+  double min_trace_;          /**< Lower bound of the covariance trace. */
+  double max_trace_;          /**< Upper bound of the covariance trace. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__RECURSIVE_LEAST_SQUARES_HPP_
@@ -0,0 +1,152 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__REFERENCE_PREFILTER_HPP_
+#define CONTROL_TOOLBOX__REFERENCE_PREFILTER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "control_toolbox/notch_filter.hpp"
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/*!
+ * \brief Discretizes a second order transfer function with the bilinear transform.
+ *
+ * \f$H(s) = \frac{n_2 s^2 + n_1 s + n_0}{d_2 s^2 + d_1 s + d_0}\f$
+ *
+ * \param numerator Coefficients \f$n_0, n_1, n_2\f$.
+ * \param denominator Coefficients \f$d_0, d_1, d_2\f$.
+ * \param sample_rate Sample rate in Hz.
+ * \param prewarp_frequency Frequency in Hz where the discrete response matches exactly,
+ *        0 for no prewarping.
+ */
+CONTROL_TOOLBOX_PUBLIC BiquadCoefficients discretizeBiquad(
+  const std::array<double, 3> & numerator, const std::array<double, 3> & denominator,
+  double sample_rate, double prewarp_frequency = 0.0);
+
+/***************************************************/
+/*! \class ReferencePrefilter
+    \brief Shapes references before they reach a Pid
+
+    Filtering the setpoints with a smooth response keeps steps from
+    saturating the actuators, so the feedback gains of the Pid can be
+    raised. Typical usage is:<br>
+
+    \code
+    prefilter.update(references, filtered);
+    command[i] = pid[i].computeCommand(filtered[i] - measured[i], dt);
+    \endcode
+
+    The filter is either critically damped of second order,<br>
+
+    \f$H(s) = \frac{\omega^2}{(s + \omega)^2}\f$<br>
+
+    which follows steps without overshoot, or a given model of the
+    desired closed loop response. It is discretized once at
+    initialization, and several channels share the coefficients.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC ReferencePrefilter
+{
+public:
+  /*!
+   * \brief Constructor, the filter has no channel until initialized
+   */
+  ReferencePrefilter();
+
+  /*!
+   * \brief Initializes a critically damped second order filter. Not realtime safe.
+   *
+   * \param num_channels Number of filtered references.
+   * \param bandwidth Frequency of the double pole in Hz, below the Nyquist frequency.
+   * \param sample_rate Sample rate in Hz.
+   */
+  bool initCriticallyDamped(std::size_t num_channels, double bandwidth, double sample_rate);
+
+  /*!
+   * \brief Initializes a model matching filter. Not realtime safe.
+   *
+   * \param num_channels Number of filtered references.
+   * \param numerator Numerator of the model, see discretizeBiquad().
+   * \param denominator Denominator of the model, see discretizeBiquad().
+   * \param sample_rate Sample rate in Hz.
+   */
+  bool initModelMatching(
+    std::size_t num_channels, const std::array<double, 3> & numerator,
+    const std::array<double, 3> & denominator, double sample_rate);
+
+  /*!
+   * \brief Sets all channels at rest on the given references
+   */
+  void reset(const std::vector<double> & references);
+
+  /*!
+   * \brief Filter one sample of each channel. Called in RT loop.
+   *
+   * \param references References, one per channel.
+   * \param filtered (output) Filtered references, resized to the number of channels.
+   * \return False if the number of references differs from the number of channels, the
+   *         channels and the filtered references are then left unchanged.
+   */
+  bool update(const std::vector<double> & references, std::vector<double> & filtered);
+
+  /*!
+   * \brief Filter one sample of a single channel. Called in RT loop.
+   */
+  double update(std::size_t channel, double reference);
+
+  /*!
+   * \brief Return the discrete coefficients of the filter
+   */
+  const BiquadCoefficients & getCoefficients() const;
+
+  /*!
+   * \brief Return the number of channels
+   */
+  std::size_t size() const;
+
+private:
+  bool setCoefficients(std::size_t num_channels, const BiquadCoefficients & coefficients);
+
+  BiquadCoefficients coefficients_; /**< Coefficients shared by all channels. */
+  std::vector<double> state1_;      /**< First delay of each channel. */
+  std::vector<double> state2_;      /**< Second delay of each channel. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__REFERENCE_PREFILTER_HPP_
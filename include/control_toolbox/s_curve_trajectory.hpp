@@ -0,0 +1,172 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__S_CURVE_TRAJECTORY_HPP_
+#define CONTROL_TOOLBOX__S_CURVE_TRAJECTORY_HPP_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class SCurveTrajectory
+    \brief Time optimal jerk limited point to point trajectory
+
+    This class plans a rest to rest move with bounded velocity,
+    acceleration and jerk. The profile has up to seven segments of
+    constant jerk: jerk up, constant acceleration, jerk down, cruise,
+    and the mirrored deceleration. Segments vanish when the limits
+    cannot be reached over the distance, the planning is closed form.
+
+    The state at the start of each segment is precomputed, so sampling
+    the trajectory is a constant time polynomial evaluation.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC SCurveTrajectory
+{
+public:
+  /*!
+   * \brief Constructor, the trajectory holds position 0 until initialized
+   */
+  SCurveTrajectory();
+
+  /*!
+   * \brief Plans the time optimal trajectory between two positions.
+   *
+   * \param start Start position, at rest.
+   * \param goal Goal position, at rest.
+   * \param max_velocity Velocity limit, > 0.
+   * \param max_acceleration Acceleration limit, > 0.
+   * \param max_jerk Jerk limit, > 0.
+   */
+  bool init(
+    double start, double goal, double max_velocity, double max_acceleration, double max_jerk);
+
+  /*!
+   * \brief Slows the trajectory down to last \c duration, e.g. to end together with other axes.
+   *
+   * Time is scaled uniformly, so the shape is kept and the limits remain satisfied.
+   *
+   * \param duration New duration, not shorter than the current one.
+   */
+  bool scaleToDuration(double duration);
+
+  /*!
+   * \brief Return the duration of the trajectory
+   */
+  double getDuration() const;
+
+  /*!
+   * \brief Gets the position and derivatives of the trajectory at a given time
+   *
+   * Before the start and after the end the trajectory holds its end points.
+   *
+   * \param time Time since the start of the trajectory
+   * \param qd (output) Velocity
+   * \param qdd (output) Acceleration
+   * \return The position
+   */
+  double update(double time, double & qd, double & qdd) const;
+
+private:
+  void computeBoundaries();
+
+  static constexpr std::size_t NUM_SEGMENTS = 7;
+
+  std::array<double, NUM_SEGMENTS> durations_;         /**< Duration of each segment. */
+  std::array<double, NUM_SEGMENTS> jerks_;             /**< Jerk of each segment. */
+  std::array<double, NUM_SEGMENTS + 1> times_;         /**< Start time of each segment. */
+  std::array<double, NUM_SEGMENTS + 1> positions_;     /**< Position at each start time. */
+  std::array<double, NUM_SEGMENTS + 1> velocities_;    /**< Velocity at each start time. */
+  std::array<double, NUM_SEGMENTS + 1> accelerations_; /**< Acceleration at each start time. */
+};
+
+/***************************************************/
+/*! \class SynchronizedSCurveTrajectory
+    \brief Jerk limited point to point trajectories for several axes
+
+    Each axis is planned with its own limits, then the faster axes are
+    slowed down to finish together with the slowest one.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC SynchronizedSCurveTrajectory
+{
+public:
+  /*!
+   * \brief Plans all axes and synchronizes them. Not realtime safe.
+   *
+   * All vectors must have the same size, see SCurveTrajectory::init().
+   */
+  bool init(
+    const std::vector<double> & start, const std::vector<double> & goal,
+    const std::vector<double> & max_velocity, const std::vector<double> & max_acceleration,
+    const std::vector<double> & max_jerk);
+
+  /*!
+   * \brief Return the duration of the synchronized trajectory
+   */
+  double getDuration() const;
+
+  /*!
+   * \brief Return the number of axes
+   */
+  std::size_t size() const;
+
+  /*!
+   * \brief Gets the positions and derivatives of all axes at a given time
+   *
+   * The output vectors are resized to the number of axes, which does not
+   * allocate once they have the right size.
+   *
+   * \param time Time since the start of the trajectory
+   * \param q (output) Positions
+   * \param qd (output) Velocities
+   * \param qdd (output) Accelerations
+   */
+  void update(
+    double time, std::vector<double> & q, std::vector<double> & qd,
+    std::vector<double> & qdd) const;
+
+private:
+  std::vector<SCurveTrajectory> axes_; /**< One trajectory per axis. */
+  double duration_ = 0.0;              /**< Duration of the slowest axis. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__S_CURVE_TRAJECTORY_HPP_
@@ -0,0 +1,151 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__SPLINE_INTERPOLATOR_HPP_
+#define CONTROL_TOOLBOX__SPLINE_INTERPOLATOR_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class SplineInterpolator
+    \brief Upsamples streamed references of several axes with splines
+
+    References received at a low rate are added as knots, and the
+    interpolator is evaluated at the rate of the control loop, e.g. to
+    feed Pid::computeCommand(error, error_dot, dt) with a continuous
+    derivative.
+
+    The derivatives at a knot are estimated with finite differences
+    from its neighbours, so a segment can be evaluated once the knot
+    after its end has been received: the evaluation time should lag
+    the newest reference by more than one reference period. Knots are
+    buffered in a ring of fixed size, which sets how far ahead
+    references can be queued.
+
+    Cubic Hermite segments have a continuous velocity, quintic segments
+    also have a continuous acceleration. The polynomial coefficients are
+    computed once per knot and stored per axis, so each sample is a
+    Horner evaluation.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC SplineInterpolator
+{
+public:
+  /*!
+   * \brief Order of the interpolating polynomials
+   */
+  enum class Order
+  {
+    CUBIC,
+    QUINTIC
+  };
+
+  /*!
+   * \brief Constructor
+   */
+  SplineInterpolator();
+
+  /*!
+   * \brief Allocates the buffers. Not realtime safe.
+   *
+   * \param num_axes Number of interpolated axes.
+   * \param order Order of the interpolating polynomials.
+   * \param buffer_size Maximum number of buffered knots, at least 3.
+   */
+  bool init(std::size_t num_axes, Order order, std::size_t buffer_size);
+
+  /*!
+   * \brief Clear the buffered knots
+   */
+  void reset();
+
+  /*!
+   * \brief Add a reference. Realtime safe.
+   *
+   * \param time Time of the reference, after the previous one.
+   * \param positions Reference of each axis.
+   * \return False if the buffer is full or the knot is invalid.
+   */
+  bool addKnot(double time, const std::vector<double> & positions);
+
+  /*!
+   * \brief Evaluate the interpolated reference. Realtime safe.
+   *
+   * Knots that are no longer needed are dropped. If no segment can be
+   * evaluated at \c time, e.g. when the references arrive late, the
+   * last knot passed is held with zero derivatives.
+   *
+   * \param time Evaluation time, not decreasing between calls.
+   * \param q (output) Positions, resized to the number of axes.
+   * \param qd (output) Velocities, resized to the number of axes.
+   * \param qdd (output) Accelerations, resized to the number of axes.
+   * \return False if no segment covers \c time.
+   */
+  bool update(
+    double time, std::vector<double> & q, std::vector<double> & qd, std::vector<double> & qdd);
+
+  /*!
+   * \brief Return the number of buffered knots
+   */
+  std::size_t getNumKnots() const;
+
+private:
+  static constexpr std::size_t NUM_COEFFICIENTS = 6;
+
+  std::size_t slot(std::size_t knot) const;
+  void computeDerivatives(std::size_t knot);
+  void computeCoefficients(std::size_t knot);
+  void hold(
+    std::size_t knot, std::vector<double> & q, std::vector<double> & qd,
+    std::vector<double> & qdd) const;
+
+  std::size_t num_axes_;              /**< Number of axes. */
+  Order order_;                       /**< Order of the polynomials. */
+  std::size_t buffer_size_;           /**< Capacity of the ring buffer. */
+  std::size_t head_;                  /**< Slot of the oldest knot. */
+  std::size_t num_knots_;             /**< Number of buffered knots. */
+  std::vector<double> times_;         /**< Knot times, per slot. */
+  std::vector<double> positions_;     /**< Knot positions, per slot and axis. */
+  std::vector<double> velocities_;    /**< Knot velocities, per slot and axis. */
+  std::vector<double> accelerations_; /**< Knot accelerations, per slot and axis. */
+  std::vector<double> coefficients_;  /**< Segment coefficients, per slot, power and axis. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__SPLINE_INTERPOLATOR_HPP_
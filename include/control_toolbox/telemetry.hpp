@@ -0,0 +1,198 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__TELEMETRY_HPP_
+#define CONTROL_TOOLBOX__TELEMETRY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "control_toolbox/visibility_control.hpp"
+
+namespace control_toolbox
+{
+struct TelemetryHeader;
+
+/***************************************************/
+/*! \class TelemetryWriter
+    \brief Exports samples of named signals to a shared memory ring
+
+    The writer creates a POSIX shared memory object holding a header,
+    a directory of channel names and a ring of records. Each record is
+    a time stamp and one value per channel. Readers on the same machine
+    attach to the object by name, see TelemetryReader, and find the
+    layout in the header, so the writer needs no knowledge of them.
+
+    Writing a record copies the values into the ring and publishes it
+    with a sequence number: no system call, lock or allocation, and
+    readers cannot slow the writer down. Slow readers lose the records
+    that have been overwritten.
+
+    Only available on POSIX systems, init() fails elsewhere.
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC TelemetryWriter
+{
+public:
+  static constexpr std::size_t MAX_CHANNELS = 64;
+  static constexpr std::size_t MAX_NAME_LENGTH = 47;
+
+  TelemetryWriter();
+
+  /*!
+   * \brief Removes the shared memory object
+   */
+  ~TelemetryWriter();
+
+  TelemetryWriter(const TelemetryWriter &) = delete;
+  TelemetryWriter & operator=(const TelemetryWriter &) = delete;
+
+  /*!
+   * \brief Creates the shared memory object. Not realtime safe.
+   *
+   * An object of the same name is replaced by a new one: writers still mapping the old object
+   * keep writing to it, readers attaching from now on find the new one.
+   *
+   * \param name Name of the object, e.g. "/joint1_pid".
+   * \param channels Names of the channels, at most MAX_CHANNELS of at most MAX_NAME_LENGTH
+   *        characters.
+   * \param capacity Number of records in the ring.
+   */
+  bool init(
+    const std::string & name, const std::vector<std::string> & channels, std::size_t capacity);
+
+  /*!
+   * \brief Unmaps and removes the shared memory object. Not realtime safe.
+   *
+   * The name is left in place if a newer writer replaced the object since init().
+   */
+  void close();
+
+  /*!
+   * \brief Appends a record to the ring. Realtime safe.
+   *
+   * \param stamp Time stamp of the record in nanoseconds.
+   * \param values One value per channel.
+   */
+  void write(int64_t stamp, const double * values);
+
+  /*!
+   * \brief Return the number of channels, 0 if not initialized
+   */
+  std::size_t getNumChannels() const;
+
+private:
+  std::string name_;         /**< Name of the shared memory object. */
+  uint64_t device_;          /**< Device of the shared memory object. */
+  uint64_t inode_;           /**< Inode of the shared memory object. */
+  void * memory_;            /**< Mapped shared memory. */
+  std::size_t size_;         /**< Size of the mapping. */
+  TelemetryHeader * header_; /**< Header at the start of the mapping. */
+  unsigned char * records_;  /**< First record. */
+  uint64_t next_index_;      /**< Index of the next record. */
+};
+
+/*!
+ * \brief A record read from a telemetry ring
+ */
+struct TelemetrySample
+{
+  uint64_t index = 0;         /**< Index of the record since the writer started. */
+  int64_t stamp = 0;          /**< Time stamp in nanoseconds. */
+  std::vector<double> values; /**< One value per channel. */
+};
+
+/***************************************************/
+/*! \class TelemetryReader
+    \brief Reads the records of a TelemetryWriter from another process
+*/
+/***************************************************/
+
+class CONTROL_TOOLBOX_PUBLIC TelemetryReader
+{
+public:
+  TelemetryReader();
+
+  ~TelemetryReader();
+
+  TelemetryReader(const TelemetryReader &) = delete;
+  TelemetryReader & operator=(const TelemetryReader &) = delete;
+
+  /*!
+   * \brief Maps an existing telemetry object, read only
+   *
+   * Reading starts at the oldest record still in the ring.
+   *
+   * \param name Name of the object, as given to TelemetryWriter::init().
+   * \return False if the object does not exist or has an unknown layout.
+   */
+  bool attach(const std::string & name);
+
+  /*!
+   * \brief Unmaps the telemetry object
+   */
+  void detach();
+
+  /*!
+   * \brief Return the names of the channels
+   */
+  const std::vector<std::string> & getChannels() const;
+
+  /*!
+   * \brief Reads the next record
+   *
+   * \param sample (output) The record.
+   * \return False if no new record is available.
+   */
+  bool read(TelemetrySample & sample);
+
+  /*!
+   * \brief Return the number of records overwritten before they could be read
+   */
+  uint64_t getNumDropped() const;
+
+private:
+  void * memory_;                     /**< Mapped shared memory. */
+  std::size_t size_;                  /**< Size of the mapping. */
+  const TelemetryHeader * header_;    /**< Header at the start of the mapping. */
+  const unsigned char * records_;     /**< First record. */
+  std::vector<std::string> channels_; /**< Channel names. */
+  uint64_t cursor_;                   /**< Index of the next record to read. */
+  uint64_t num_dropped_;              /**< Records lost. */
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__TELEMETRY_HPP_
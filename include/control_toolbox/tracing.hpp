@@ -0,0 +1,168 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__TRACING_HPP_
+#define CONTROL_TOOLBOX__TRACING_HPP_
+
+/*
+  Static tracepoints of the control_toolbox hot paths.
+
+  When the library is built with CONTROL_TOOLBOX_TRACING, which the build
+  enables if sys/sdt.h is available (systemtap-sdt-dev, see package.xml),
+  every tracepoint is a USDT probe of the provider "control_toolbox", with
+  a semaphore that tracers increment while they are attached. An
+  unattached probe costs a load and a not taken branch on its semaphore,
+  its arguments are not evaluated and the probe itself is a nop behind
+  the branch. So the probes stay compiled in and are only attached to
+  when needed, e.g.
+
+    bpftrace -e 'usdt:lib/libcontrol_toolbox.so:control_toolbox:pid_compute_command_entry
+                 { @start[tid] = nsecs; }
+                 usdt:lib/libcontrol_toolbox.so:control_toolbox:pid_compute_command_exit
+                 { @ns = hist(nsecs - @start[tid]); }'
+
+  or with perf probe / perf record. Otherwise the tracepoints expand to
+  nothing and their arguments are not evaluated.
+
+  Most tracers cannot read floating point registers, so floating point
+  payloads are passed as the 64 bit pattern of the IEEE 754 double and
+  integers as 64 bit signed integers.
+
+  A new probe must be added to CONTROL_TOOLBOX_PROBES, which defines its
+  semaphore in tracing.cpp.
+*/
+
+// Every probe of the library
+#define CONTROL_TOOLBOX_PROBES(X)     \
+  X(limited_proxy_update_entry)       \
+  X(limited_proxy_update_exit)        \
+  X(pid_compute_command_entry)        \
+  X(pid_compute_command_exit)         \
+  X(pid_ros_parameter_callback_entry) \
+  X(pid_ros_parameter_callback_exit)  \
+  X(pid_ros_publish_state_entry)      \
+  X(pid_ros_publish_state_exit)       \
+  X(pid_set_gains_entry)              \
+  X(pid_set_gains_exit)
+
+#ifdef CONTROL_TOOLBOX_TRACING
+
+// The probes reference their semaphore, named <provider>_<probe>_semaphore
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#define CONTROL_TOOLBOX_DECLARE_SEMAPHORE(name) \
+  extern unsigned short control_toolbox_##name##_semaphore;
+extern "C" {
+CONTROL_TOOLBOX_PROBES(CONTROL_TOOLBOX_DECLARE_SEMAPHORE)
+}
+
+namespace control_toolbox
+{
+namespace tracing
+{
+template <typename T>
+inline int64_t toProbeArgument(T value)
+{
+  if constexpr (std::is_floating_point_v<T>) {
+    const double as_double = value;
+    int64_t bits;
+    std::memcpy(&bits, &as_double, sizeof(bits));
+    return bits;
+  } else {
+    return static_cast<int64_t>(value);
+  }
+}
+}  // namespace tracing
+}  // namespace control_toolbox
+
+#define CONTROL_TOOLBOX_TRACEPOINT_ENABLED(name) \
+  __builtin_expect(control_toolbox_##name##_semaphore != 0, 0)
+
+#define CONTROL_TOOLBOX_TRACEPOINT(name)              \
+  do {                                                \
+    if (CONTROL_TOOLBOX_TRACEPOINT_ENABLED(name)) {   \
+      DTRACE_PROBE(control_toolbox, name);            \
+    }                                                 \
+  } while (0)
+#define CONTROL_TOOLBOX_TRACEPOINT1(name, a1)                                               \
+  do {                                                                                      \
+    if (CONTROL_TOOLBOX_TRACEPOINT_ENABLED(name)) {                                         \
+      DTRACE_PROBE1(control_toolbox, name, control_toolbox::tracing::toProbeArgument(a1)); \
+    }                                                                                       \
+  } while (0)
+#define CONTROL_TOOLBOX_TRACEPOINT2(name, a1, a2)                                 \
+  do {                                                                            \
+    if (CONTROL_TOOLBOX_TRACEPOINT_ENABLED(name)) {                               \
+      DTRACE_PROBE2(                                                              \
+        control_toolbox, name, control_toolbox::tracing::toProbeArgument(a1),     \
+        control_toolbox::tracing::toProbeArgument(a2));                           \
+    }                                                                             \
+  } while (0)
+#define CONTROL_TOOLBOX_TRACEPOINT3(name, a1, a2, a3)                             \
+  do {                                                                            \
+    if (CONTROL_TOOLBOX_TRACEPOINT_ENABLED(name)) {                               \
+      DTRACE_PROBE3(                                                              \
+        control_toolbox, name, control_toolbox::tracing::toProbeArgument(a1),     \
+        control_toolbox::tracing::toProbeArgument(a2),                            \
+        control_toolbox::tracing::toProbeArgument(a3));                           \
+    }                                                                             \
+  } while (0)
+#define CONTROL_TOOLBOX_TRACEPOINT4(name, a1, a2, a3, a4)                         \
+  do {                                                                            \
+    if (CONTROL_TOOLBOX_TRACEPOINT_ENABLED(name)) {                               \
+      DTRACE_PROBE4(                                                              \
+        control_toolbox, name, control_toolbox::tracing::toProbeArgument(a1),     \
+        control_toolbox::tracing::toProbeArgument(a2),                            \
+        control_toolbox::tracing::toProbeArgument(a3),                            \
+        control_toolbox::tracing::toProbeArgument(a4));                           \
+    }                                                                             \
+  } while (0)
+
+#else
+
+#define CONTROL_TOOLBOX_TRACEPOINT_ENABLED(name) false
+#define CONTROL_TOOLBOX_TRACEPOINT(name) \
+  do {                                   \
+  } while (0)
+#define CONTROL_TOOLBOX_TRACEPOINT1(name, a1) CONTROL_TOOLBOX_TRACEPOINT(name)
+#define CONTROL_TOOLBOX_TRACEPOINT2(name, a1, a2) CONTROL_TOOLBOX_TRACEPOINT(name)
+#define CONTROL_TOOLBOX_TRACEPOINT3(name, a1, a2, a3) CONTROL_TOOLBOX_TRACEPOINT(name)
+#define CONTROL_TOOLBOX_TRACEPOINT4(name, a1, a2, a3, a4) CONTROL_TOOLBOX_TRACEPOINT(name)
+
+#endif  // CONTROL_TOOLBOX_TRACING
+
+#endif  // CONTROL_TOOLBOX__TRACING_HPP_
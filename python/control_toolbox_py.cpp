@@ -0,0 +1,388 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Python bindings of Pid, LimitedProxy and the signal generators for offline simulation and
+// tuning. Besides the per sample methods, each class has batch methods that process whole NumPy
+// arrays in C++ with the GIL released. Arrays of several channels are (samples x channels),
+// each channel is processed by its own copy of the object.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "pybind11/numpy.h"
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+
+#include "control_toolbox/dither.hpp"
+#include "control_toolbox/limited_proxy.hpp"
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/sine_sweep.hpp"
+#include "control_toolbox/sinusoid.hpp"
+
+namespace py = pybind11;
+
+using control_toolbox::Dither;
+using control_toolbox::LimitedProxy;
+using control_toolbox::Pid;
+using control_toolbox::SineSweep;
+using control_toolbox::Sinusoid;
+
+namespace
+{
+// Contiguous array of doubles, converted if needed
+using Array = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+std::size_t numSamples(const Array & array) { return array.ndim() == 0 ? 0 : array.shape(0); }
+
+std::size_t numChannels(const Array & array) { return array.ndim() == 2 ? array.shape(1) : 1; }
+
+void checkShape(const Array & array, const Array & reference, const char * name)
+{
+  if (array.ndim() != reference.ndim() || numSamples(array) != numSamples(reference) ||
+      numChannels(array) != numChannels(reference)) {
+    throw py::value_error(std::string(name) + " does not have the shape of the first input");
+  }
+}
+
+void checkSamples(const Array & array, const char * name)
+{
+  if (array.ndim() != 1 && array.ndim() != 2) {
+    throw py::value_error(std::string(name) + " must be (samples) or (samples x channels)");
+  }
+}
+
+Array emptyLike(const Array & reference)
+{
+  std::vector<py::ssize_t> shape(reference.shape(), reference.shape() + reference.ndim());
+  return Array(shape);
+}
+
+uint64_t toNanoseconds(double dt)
+{
+  if (!(dt > 0.0)) {
+    throw py::value_error("dt must be positive");
+  }
+  return static_cast<uint64_t>(std::llround(dt * 1e9));
+}
+
+// Runs computeCommand over (samples x channels) errors, with the derivative of the error if
+// error_dots is not null
+void computePidCommands(
+  const std::vector<Pid *> & pids, const double * errors, const double * error_dots, uint64_t dt,
+  std::size_t samples, double * commands)
+{
+  const std::size_t channels = pids.size();
+  for (std::size_t k = 0; k < samples; ++k) {
+    for (std::size_t c = 0; c < channels; ++c) {
+      const std::size_t n = k * channels + c;
+      commands[n] = error_dots ? pids[c]->computeCommand(errors[n], error_dots[n], dt)
+                               : pids[c]->computeCommand(errors[n], dt);
+    }
+  }
+}
+
+Array pidComputeCommands(
+  const std::vector<Pid *> & pids, const Array & errors, double dt, const py::object & error_dots)
+{
+  checkSamples(errors, "errors");
+  if (numChannels(errors) != pids.size()) {
+    throw py::value_error("errors must have one column per channel");
+  }
+  Array dots;
+  if (!error_dots.is_none()) {
+    dots = error_dots.cast<Array>();
+    checkShape(dots, errors, "error_dots");
+  }
+  const uint64_t dt_ns = toNanoseconds(dt);
+  Array commands = emptyLike(errors);
+  const double * error_data = errors.data();
+  const double * dot_data = error_dots.is_none() ? nullptr : dots.data();
+  double * command_data = commands.mutable_data();
+  {
+    py::gil_scoped_release release;
+    computePidCommands(pids, error_data, dot_data, dt_ns, numSamples(errors), command_data);
+  }
+  return commands;
+}
+
+Array proxyUpdate(
+  const std::vector<LimitedProxy *> & proxies, const Array & pos_des, const Array & vel_des,
+  const Array & acc_des, const Array & pos_act, const Array & vel_act, double dt)
+{
+  checkSamples(pos_des, "pos_des");
+  checkShape(vel_des, pos_des, "vel_des");
+  checkShape(acc_des, pos_des, "acc_des");
+  checkShape(pos_act, pos_des, "pos_act");
+  checkShape(vel_act, pos_des, "vel_act");
+  if (!(dt > 0.0)) {
+    throw py::value_error("dt must be positive");
+  }
+  const std::size_t samples = numSamples(pos_des);
+  const std::size_t channels = proxies.size();
+  Array forces = emptyLike(pos_des);
+  const double * pd = pos_des.data();
+  const double * vd = vel_des.data();
+  const double * ad = acc_des.data();
+  const double * pa = pos_act.data();
+  const double * va = vel_act.data();
+  double * force = forces.mutable_data();
+  {
+    py::gil_scoped_release release;
+    for (std::size_t k = 0; k < samples; ++k) {
+      for (std::size_t c = 0; c < channels; ++c) {
+        const std::size_t n = k * channels + c;
+        force[n] = proxies[c]->update(pd[n], vd[n], ad[n], pa[n], va[n], dt);
+      }
+    }
+  }
+  return forces;
+}
+}  // namespace
+
+PYBIND11_MODULE(control_toolbox_py, m)
+{
+  m.doc() = "Python bindings of the control_toolbox controllers and signal generators";
+
+  py::class_<Pid::Gains>(m, "Gains")
+    .def(
+      py::init<double, double, double, double, double, bool>(), py::arg("p") = 0.0,
+      py::arg("i") = 0.0, py::arg("d") = 0.0, py::arg("i_max") = 0.0, py::arg("i_min") = 0.0,
+      py::arg("antiwindup") = false)
+    .def_readwrite("p", &Pid::Gains::p_gain_)
+    .def_readwrite("i", &Pid::Gains::i_gain_)
+    .def_readwrite("d", &Pid::Gains::d_gain_)
+    .def_readwrite("i_max", &Pid::Gains::i_max_)
+    .def_readwrite("i_min", &Pid::Gains::i_min_)
+    .def_readwrite("antiwindup", &Pid::Gains::antiwindup_);
+
+  py::class_<Pid>(m, "Pid")
+    .def(
+      py::init<double, double, double, double, double, bool>(), py::arg("p") = 0.0,
+      py::arg("i") = 0.0, py::arg("d") = 0.0, py::arg("i_max") = 0.0, py::arg("i_min") = 0.0,
+      py::arg("antiwindup") = false)
+    .def("reset", &Pid::reset)
+    .def("get_gains", [](Pid & pid) { return pid.getGainsNonRT(); })
+    .def("set_gains", py::overload_cast<const Pid::Gains &>(&Pid::setGains), py::arg("gains"))
+    .def(
+      "compute_command",
+      [](Pid & pid, double error, double dt) {
+        return pid.computeCommand(error, toNanoseconds(dt));
+      },
+      py::arg("error"), py::arg("dt"))
+    .def(
+      "compute_command",
+      [](Pid & pid, double error, double error_dot, double dt) {
+        return pid.computeCommand(error, error_dot, toNanoseconds(dt));
+      },
+      py::arg("error"), py::arg("error_dot"), py::arg("dt"))
+    .def(
+      "compute_commands",
+      [](Pid & pid, const Array & errors, double dt, const py::object & error_dots) {
+        if (errors.ndim() != 1) {
+          throw py::value_error("errors must be (samples), use compute_pid_commands for channels");
+        }
+        return pidComputeCommands({&pid}, errors, dt, error_dots);
+      },
+      py::arg("errors"), py::arg("dt"), py::arg("error_dots") = py::none(),
+      "Computes the commands of consecutive samples, dt in seconds. The state is kept.")
+    .def(
+      "get_current_pid_errors",
+      [](Pid & pid) {
+        double pe, ie, de;
+        pid.getCurrentPIDErrors(pe, ie, de);
+        return std::make_tuple(pe, ie, de);
+      })
+    .def("get_current_cmd", &Pid::getCurrentCmd);
+
+  m.def(
+    "compute_pid_commands",
+    [](const std::vector<Pid::Gains> & gains, const Array & errors, double dt,
+       const py::object & error_dots) {
+      if (errors.ndim() != 2) {
+        throw py::value_error("errors must be (samples x channels)");
+      }
+      // Pid is neither copied nor moved, as copies are reset
+      std::vector<std::unique_ptr<Pid>> storage;
+      std::vector<Pid *> pids;
+      for (const auto & g : gains) {
+        storage.push_back(std::make_unique<Pid>(
+          g.p_gain_, g.i_gain_, g.d_gain_, g.i_max_, g.i_min_, g.antiwindup_));
+        pids.push_back(storage.back().get());
+      }
+      return pidComputeCommands(pids, errors, dt, error_dots);
+    },
+    py::arg("gains"), py::arg("errors"), py::arg("dt"), py::arg("error_dots") = py::none(),
+    "Runs one Pid per channel, from reset, over (samples x channels) errors.");
+
+  py::class_<LimitedProxy>(m, "LimitedProxy")
+    .def(py::init<>())
+    .def_readwrite("mass", &LimitedProxy::mass_)
+    .def_readwrite("Kd", &LimitedProxy::Kd_)
+    .def_readwrite("Kp", &LimitedProxy::Kp_)
+    .def_readwrite("Ki", &LimitedProxy::Ki_)
+    .def_readwrite("Ficl", &LimitedProxy::Ficl_)
+    .def_readwrite("effort_limit", &LimitedProxy::effort_limit_)
+    .def_readwrite("vel_limit", &LimitedProxy::vel_limit_)
+    .def_readwrite("pos_upper_limit", &LimitedProxy::pos_upper_limit_)
+    .def_readwrite("pos_lower_limit", &LimitedProxy::pos_lower_limit_)
+    .def_readwrite("lambda_proxy", &LimitedProxy::lambda_proxy_)
+    .def_readwrite("acc_converge", &LimitedProxy::acc_converge_)
+    .def("reset", &LimitedProxy::reset, py::arg("pos_act"), py::arg("vel_act"))
+    .def(
+      "update", &LimitedProxy::update, py::arg("pos_des"), py::arg("vel_des"), py::arg("acc_des"),
+      py::arg("pos_act"), py::arg("vel_act"), py::arg("dt"))
+    .def(
+      "update_batch",
+      [](LimitedProxy & proxy, const Array & pos_des, const Array & vel_des,
+         const Array & acc_des, const Array & pos_act, const Array & vel_act, double dt) {
+        if (pos_des.ndim() != 1) {
+          throw py::value_error("inputs must be (samples), use update_channels for channels");
+        }
+        return proxyUpdate({&proxy}, pos_des, vel_des, acc_des, pos_act, vel_act, dt);
+      },
+      py::arg("pos_des"), py::arg("vel_des"), py::arg("acc_des"), py::arg("pos_act"),
+      py::arg("vel_act"), py::arg("dt"),
+      "Computes the forces of consecutive samples. The state is kept.")
+    .def(
+      "update_channels",
+      [](const LimitedProxy & proxy, const Array & pos_des, const Array & vel_des,
+         const Array & acc_des, const Array & pos_act, const Array & vel_act, double dt) {
+        if (pos_des.ndim() != 2 || numSamples(pos_des) == 0) {
+          throw py::value_error("inputs must be (samples x channels)");
+        }
+        checkShape(pos_act, pos_des, "pos_act");
+        checkShape(vel_act, pos_des, "vel_act");
+        std::vector<LimitedProxy> copies(numChannels(pos_des), proxy);
+        std::vector<LimitedProxy *> proxies;
+        for (std::size_t c = 0; c < copies.size(); ++c) {
+          copies[c].reset(pos_act.at(0, c), vel_act.at(0, c));
+          proxies.push_back(&copies[c]);
+        }
+        return proxyUpdate(proxies, pos_des, vel_des, acc_des, pos_act, vel_act, dt);
+      },
+      py::arg("pos_des"), py::arg("vel_des"), py::arg("acc_des"), py::arg("pos_act"),
+      py::arg("vel_act"), py::arg("dt"),
+      "Runs one copy of this proxy per channel over (samples x channels) inputs, each reset to "
+      "its first actual position and velocity. This proxy is not modified.");
+
+  py::class_<Sinusoid>(m, "Sinusoid")
+    .def(
+      py::init<double, double, double, double>(), py::arg("offset"), py::arg("amplitude"),
+      py::arg("frequency"), py::arg("phase"))
+    .def(
+      "update",
+      [](Sinusoid & sinusoid, double time) {
+        double qd, qdd;
+        const double q = sinusoid.update(time, qd, qdd);
+        return std::make_tuple(q, qd, qdd);
+      },
+      py::arg("time"))
+    .def(
+      "sample",
+      [](Sinusoid & sinusoid, const Array & times) {
+        Array q = emptyLike(times), qd = emptyLike(times), qdd = emptyLike(times);
+        const double * t = times.data();
+        double * q_data = q.mutable_data();
+        double * qd_data = qd.mutable_data();
+        double * qdd_data = qdd.mutable_data();
+        const std::size_t size = times.size();
+        {
+          py::gil_scoped_release release;
+          for (std::size_t k = 0; k < size; ++k) {
+            q_data[k] = sinusoid.update(t[k], qd_data[k], qdd_data[k]);
+          }
+        }
+        return std::make_tuple(q, qd, qdd);
+      },
+      py::arg("times"), "Returns the value and its two derivatives at each time, in seconds.");
+
+  py::class_<SineSweep>(m, "SineSweep")
+    .def(py::init<>())
+    .def(
+      "init", &SineSweep::init, py::arg("start_freq"), py::arg("end_freq"), py::arg("duration"),
+      py::arg("amplitude"))
+    .def(
+      "update",
+      [](SineSweep & sweep, double time) {
+        return sweep.update(rclcpp::Duration::from_seconds(time));
+      },
+      py::arg("time"))
+    .def(
+      "sample",
+      [](SineSweep & sweep, const Array & times) {
+        Array values = emptyLike(times);
+        const double * t = times.data();
+        double * value = values.mutable_data();
+        const std::size_t size = times.size();
+        {
+          py::gil_scoped_release release;
+          for (std::size_t k = 0; k < size; ++k) {
+            value[k] = sweep.update(rclcpp::Duration::from_seconds(t[k]));
+          }
+        }
+        return values;
+      },
+      py::arg("times"), "Returns the sweep at each time since its start, in seconds.");
+
+  py::class_<Dither>(m, "Dither")
+    .def(py::init<>())
+    .def(
+      "init", [](Dither & dither, double amplitude, double seed) {
+        return dither.init(amplitude, seed);
+      },
+      py::arg("amplitude"), py::arg("seed"))
+    .def("update", &Dither::update)
+    .def(
+      "sample",
+      [](Dither & dither, py::ssize_t samples, py::ssize_t channels) {
+        if (samples < 0 || channels < 1) {
+          throw py::value_error("samples must be >= 0 and channels >= 1");
+        }
+        Array values({samples, channels});
+        double * value = values.mutable_data();
+        const std::size_t size = values.size();
+        {
+          py::gil_scoped_release release;
+          for (std::size_t k = 0; k < size; ++k) {
+            value[k] = dither.update();
+          }
+        }
+        return channels == 1 ? Array(values.reshape({samples})) : values;
+      },
+      py::arg("samples"), py::arg("channels") = 1,
+      "Returns the next samples of the noise, channel after channel within a sample.");
+}
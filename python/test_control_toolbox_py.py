@@ -0,0 +1,115 @@
+# Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+# All rights reserved.
+#
+# Software License Agreement (BSD License 2.0)
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above
+#    copyright notice, this list of conditions and the following
+#    disclaimer in the documentation and/or other materials provided
+#    with the distribution.
+#  * Neither the name of the Willow Garage nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+# CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+"""Checks that the batch APIs of the bindings match the per sample calls."""
+
+import control_toolbox_py as ct
+import numpy as np
+import pytest
+
+DT = 0.001
+
+
+def test_pid_batch_matches_samples():
+    errors = np.sin(np.linspace(0.0, 10.0, 1000))
+    error_dots = np.cos(np.linspace(0.0, 10.0, 1000))
+    batch = ct.Pid(2.0, 1.0, 0.1, 0.5, -0.5)
+    single = ct.Pid(2.0, 1.0, 0.1, 0.5, -0.5)
+
+    commands = batch.compute_commands(errors[:500], DT, error_dots[:500])
+    # The state is kept between batches
+    commands = np.concatenate(
+        [commands, batch.compute_commands(errors[500:], DT, error_dots[500:])])
+    expected = [single.compute_command(e, d, DT) for e, d in zip(errors, error_dots)]
+    np.testing.assert_array_equal(expected, commands)
+    assert batch.get_current_pid_errors() == single.get_current_pid_errors()
+
+
+def test_pid_channels():
+    errors = np.random.default_rng(42).standard_normal((200, 3))
+    gains = [ct.Gains(p, 0.5, 0.01, 1.0, -1.0) for p in (1.0, 2.0, 3.0)]
+    commands = ct.compute_pid_commands(gains, errors, DT)
+
+    assert commands.shape == errors.shape
+    for c, g in enumerate(gains):
+        pid = ct.Pid(g.p, g.i, g.d, g.i_max, g.i_min)
+        np.testing.assert_array_equal(pid.compute_commands(errors[:, c], DT), commands[:, c])
+
+
+def test_limited_proxy_batch_matches_samples():
+    def make_proxy():
+        proxy = ct.LimitedProxy()
+        proxy.mass, proxy.Kp, proxy.Kd, proxy.Ki, proxy.Ficl = 1.0, 100.0, 20.0, 10.0, 5.0
+        proxy.effort_limit, proxy.vel_limit = 50.0, 2.0
+        proxy.pos_upper_limit, proxy.pos_lower_limit = 1.0, -1.0
+        proxy.lambda_proxy, proxy.acc_converge = 10.0, 100.0
+        proxy.reset(0.0, 0.0)
+        return proxy
+
+    t = np.arange(500) * DT
+    pos_des, vel_des, acc_des = np.sin(t), np.cos(t), -np.sin(t)
+    pos_act, vel_act = 0.9 * pos_des, 0.9 * vel_des
+    single = make_proxy()
+    expected = [single.update(*sample, DT)
+                for sample in zip(pos_des, vel_des, acc_des, pos_act, vel_act)]
+    forces = make_proxy().update_batch(pos_des, vel_des, acc_des, pos_act, vel_act, DT)
+    np.testing.assert_array_equal(expected, forces)
+
+    channels = make_proxy().update_channels(
+        *(np.stack([x, x], axis=1) for x in (pos_des, vel_des, acc_des, pos_act, vel_act)), DT)
+    np.testing.assert_array_equal(expected, channels[:, 1])
+
+
+def test_generators():
+    sinusoid = ct.Sinusoid(0.5, 2.0, 3.0, 0.1)
+    times = np.linspace(0.0, 1.0, 100)
+    _, qd, _ = sinusoid.sample(times)
+    np.testing.assert_array_equal([sinusoid.update(t)[1] for t in times], qd)
+
+    sweep = ct.SineSweep()
+    assert sweep.init(1.0, 10.0, 1.0, 1.0)
+    np.testing.assert_array_equal([sweep.update(t) for t in times], sweep.sample(times))
+
+    first, second = ct.Dither(), ct.Dither()
+    assert first.init(1.0, 7) and second.init(1.0, 7)
+    noise = first.sample(100, 2)
+    assert noise.shape == (100, 2)
+    np.testing.assert_array_equal([second.update() for _ in range(200)], noise.ravel())
+
+
+def test_bad_shapes():
+    with pytest.raises(ValueError):
+        ct.compute_pid_commands([ct.Gains(1.0)], np.zeros((10, 2)), DT)
+    with pytest.raises(ValueError):
+        ct.Pid(1.0).compute_commands(np.zeros(10), DT, np.zeros(5))
+    with pytest.raises(ValueError):
+        ct.Pid(1.0).compute_commands(np.zeros(10), 0.0)
@@ -0,0 +1,146 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/delay_estimator.hpp"
+
+namespace control_toolbox
+{
+DelayEstimator::DelayEstimator()
+: head_(0),
+  forgetting_factor_(0.0),
+  input_mean_(0.0),
+  output_mean_(0.0),
+  input_power_(0.0),
+  output_power_(0.0),
+  peak_(0),
+  delay_(0.0)
+{
+}
+
+bool DelayEstimator::init(std::size_t max_lag, double forgetting_factor)
+{
+  if (forgetting_factor <= 0.0 || forgetting_factor >= 1.0) {
+    RCUTILS_LOG_ERROR("Delay estimator forgetting factor must be in (0, 1).");
+    return false;
+  }
+
+  forgetting_factor_ = forgetting_factor;
+  history_.assign(max_lag + 1, 0.0);
+  correlation_.assign(max_lag + 1, 0.0);
+  reset();
+
+  return true;
+}
+
+void DelayEstimator::reset()
+{
+  std::fill(history_.begin(), history_.end(), 0.0);
+  std::fill(correlation_.begin(), correlation_.end(), 0.0);
+  head_ = 0;
+  input_mean_ = 0.0;
+  output_mean_ = 0.0;
+  input_power_ = 0.0;
+  output_power_ = 0.0;
+  peak_ = 0;
+  delay_ = 0.0;
+}
+
+void DelayEstimator::update(double input, double output)
+{
+  const std::size_t size = history_.size();
+  if (size == 0 || !std::isfinite(input) || !std::isfinite(output)) {
+    return;
+  }
+
+  const double lambda = forgetting_factor_;
+  const double gain = 1.0 - lambda;
+
+  input_mean_ = lambda * input_mean_ + gain * input;
+  output_mean_ = lambda * output_mean_ + gain * output;
+  const double u = input - input_mean_;
+  const double y = output - output_mean_;
+  input_power_ = lambda * input_power_ + gain * u * u;
+  output_power_ = lambda * output_power_ + gain * y * y;
+
+  head_ = (head_ + 1 == size) ? 0 : head_ + 1;
+  history_[head_] = u;
+
+  // Update all lags and track the peak in the same pass, walking the history backwards
+  const double weighted_output = gain * y;
+  std::size_t index = head_;
+  double peak_value = -1.0;
+  for (std::size_t k = 0; k < size; ++k) {
+    double & r = correlation_[k];
+    r = lambda * r + weighted_output * history_[index];
+    if (std::abs(r) > peak_value) {
+      peak_value = std::abs(r);
+      peak_ = k;
+    }
+    index = (index == 0) ? size - 1 : index - 1;
+  }
+
+  // Refine with a parabola through the peak and its neighbours
+  delay_ = static_cast<double>(peak_);
+  if (peak_ > 0 && peak_ + 1 < size) {
+    const double left = std::abs(correlation_[peak_ - 1]);
+    const double center = std::abs(correlation_[peak_]);
+    const double right = std::abs(correlation_[peak_ + 1]);
+    const double curvature = left - 2.0 * center + right;
+    if (curvature < 0.0) {
+      delay_ += 0.5 * (left - right) / curvature;
+    }
+  }
+}
+
+double DelayEstimator::getDelay() const { return delay_; }
+
+double DelayEstimator::getConfidence() const
+{
+  const double power = input_power_ * output_power_;
+  if (correlation_.empty() || power <= 0.0) {
+    return 0.0;
+  }
+  return correlation_[peak_] / std::sqrt(power);
+}
+
+double DelayEstimator::getCorrelation(std::size_t lag) const
+{
+  return lag < correlation_.size() ? correlation_[lag] : 0.0;
+}
+
+}  // namespace control_toolbox
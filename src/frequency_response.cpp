@@ -0,0 +1,337 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/frequency_response.hpp"
+
+namespace control_toolbox
+{
+namespace
+{
+/// Cross and auto spectra accumulated over segments
+struct Spectra
+{
+  explicit Spectra(std::size_t bins) : pxx(bins, 0.0), pyy(bins, 0.0), pxy(bins, 0.0) {}
+
+  std::vector<double> pxx;
+  std::vector<double> pyy;
+  std::vector<std::complex<double>> pxy;
+};
+
+/// Frequency at which a quantity interpolated linearly in log-frequency reaches \c target
+double interpolateFrequency(double f0, double f1, double v0, double v1, double target)
+{
+  if (v1 == v0 || f0 <= 0.0 || f1 <= 0.0) {
+    return f0;
+  }
+  double ratio = (target - v0) / (v1 - v0);
+  return std::exp(std::log(f0) + ratio * (std::log(f1) - std::log(f0)));
+}
+}  // namespace
+
+FrequencyResponseEstimator::FrequencyResponseEstimator()
+: segment_length_(0), step_(0), sample_rate_(0.0), num_threads_(1)
+{
+}
+
+bool FrequencyResponseEstimator::init(
+  std::size_t segment_length, double overlap, double sample_rate, std::size_t num_threads)
+{
+  if (segment_length < 4 || (segment_length & (segment_length - 1)) != 0) {
+    RCUTILS_LOG_ERROR("Frequency response segment length must be a power of two >= 4.");
+    return false;
+  }
+  if (overlap < 0.0 || overlap >= 1.0 || sample_rate <= 0.0) {
+    RCUTILS_LOG_ERROR("Frequency response overlap must be in [0, 1) and sample rate > 0.");
+    return false;
+  }
+
+  segment_length_ = segment_length;
+  step_ = std::max<std::size_t>(
+    1, static_cast<std::size_t>(std::lround(segment_length * (1.0 - overlap))));
+  sample_rate_ = sample_rate;
+  num_threads_ = num_threads;
+  if (num_threads_ == 0) {
+    num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // Periodic Hann window
+  window_.resize(segment_length_);
+  for (std::size_t i = 0; i < segment_length_; ++i) {
+    window_[i] = 0.5 - 0.5 * cos(2.0 * M_PI * i / segment_length_);
+  }
+
+  twiddles_.resize(segment_length_ / 2);
+  for (std::size_t k = 0; k < twiddles_.size(); ++k) {
+    twiddles_[k] = std::polar(1.0, -2.0 * M_PI * k / segment_length_);
+  }
+
+  std::size_t bits = 0;
+  while ((std::size_t(1) << bits) < segment_length_) {
+    ++bits;
+  }
+  bit_reversal_.resize(segment_length_);
+  for (std::size_t i = 0; i < segment_length_; ++i) {
+    std::size_t reversed = 0;
+    for (std::size_t b = 0; b < bits; ++b) {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    bit_reversal_[i] = reversed;
+  }
+
+  return true;
+}
+
+void FrequencyResponseEstimator::transform(std::vector<std::complex<double>> & data) const
+{
+  const std::size_t n = segment_length_;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::size_t j = bit_reversal_[i];
+    if (i < j) {
+      std::swap(data[i], data[j]);
+    }
+  }
+
+  for (std::size_t len = 2; len <= n; len <<= 1) {
+    const std::size_t half = len / 2;
+    const std::size_t stride = n / len;
+    for (std::size_t i = 0; i < n; i += len) {
+      for (std::size_t k = 0; k < half; ++k) {
+        std::complex<double> u = data[i + k];
+        std::complex<double> v = data[i + k + half] * twiddles_[k * stride];
+        data[i + k] = u + v;
+        data[i + k + half] = u - v;
+      }
+    }
+  }
+}
+
+bool FrequencyResponseEstimator::estimate(
+  const std::vector<double> & input, const std::vector<double> & output,
+  FrequencyResponse & response) const
+{
+  if (segment_length_ == 0) {
+    RCUTILS_LOG_ERROR("Frequency response estimator is not initialized.");
+    return false;
+  }
+  if (input.size() != output.size() || input.size() < segment_length_) {
+    RCUTILS_LOG_ERROR(
+      "Frequency response records must have the same length and hold at least one segment.");
+    return false;
+  }
+
+  const std::size_t n = segment_length_;
+  const std::size_t bins = n / 2 + 1;
+  const std::size_t num_segments = (input.size() - n) / step_ + 1;
+  const std::size_t num_workers = std::min(num_threads_, num_segments);
+
+  std::vector<Spectra> partial(num_workers, Spectra(bins));
+
+  auto worker = [&](std::size_t w) {
+    Spectra & spectra = partial[w];
+    std::vector<std::complex<double>> buffer(n);
+    for (std::size_t s = w; s < num_segments; s += num_workers) {
+      const std::size_t offset = s * step_;
+
+      // Remove the mean of each segment before windowing
+      double mean_x = 0.0, mean_y = 0.0;
+      for (std::size_t i = 0; i < n; ++i) {
+        mean_x += input[offset + i];
+        mean_y += output[offset + i];
+      }
+      mean_x /= n;
+      mean_y /= n;
+
+      // Pack both real records into a single complex one
+      for (std::size_t i = 0; i < n; ++i) {
+        buffer[i] = std::complex<double>(
+          (input[offset + i] - mean_x) * window_[i], (output[offset + i] - mean_y) * window_[i]);
+      }
+      transform(buffer);
+
+      for (std::size_t k = 1; k < bins; ++k) {
+        const std::complex<double> z = buffer[k];
+        const std::complex<double> z_conj = std::conj(buffer[(n - k) % n]);
+        const std::complex<double> x = 0.5 * (z + z_conj);
+        const std::complex<double> y = std::complex<double>(0.0, -0.5) * (z - z_conj);
+        spectra.pxx[k] += std::norm(x);
+        spectra.pyy[k] += std::norm(y);
+        spectra.pxy[k] += std::conj(x) * y;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers - 1);
+  for (std::size_t w = 1; w < num_workers; ++w) {
+    threads.emplace_back(worker, w);
+  }
+  worker(0);
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  for (std::size_t w = 1; w < num_workers; ++w) {
+    for (std::size_t k = 1; k < bins; ++k) {
+      partial[0].pxx[k] += partial[w].pxx[k];
+      partial[0].pyy[k] += partial[w].pyy[k];
+      partial[0].pxy[k] += partial[w].pxy[k];
+    }
+  }
+
+  const Spectra & spectra = partial[0];
+  response.sample_rate = sample_rate_;
+  response.frequencies.resize(bins - 1);
+  response.response.resize(bins - 1);
+  response.coherence.resize(bins - 1);
+  for (std::size_t k = 1; k < bins; ++k) {
+    response.frequencies[k - 1] = k * sample_rate_ / n;
+    if (spectra.pxx[k] > 0.0) {
+      response.response[k - 1] = spectra.pxy[k] / spectra.pxx[k];
+    } else {
+      response.response[k - 1] = 0.0;
+    }
+    const double power = spectra.pxx[k] * spectra.pyy[k];
+    response.coherence[k - 1] = power > 0.0 ? std::norm(spectra.pxy[k]) / power : 0.0;
+  }
+
+  return true;
+}
+
+std::complex<double> evaluatePidResponse(
+  const Pid::Gains & gains, double frequency, double sample_rate)
+{
+  const std::complex<double> j(0.0, 1.0);
+  if (sample_rate > 0.0) {
+    // Rectangular integration and backward difference, as in Pid::computeCommand
+    const double dt = 1.0 / sample_rate;
+    const std::complex<double> z_inv = std::exp(-j * 2.0 * M_PI * frequency * dt);
+    return gains.p_gain_ + gains.i_gain_ * dt / (1.0 - z_inv) + gains.d_gain_ * (1.0 - z_inv) / dt;
+  }
+  const std::complex<double> s = j * 2.0 * M_PI * frequency;
+  return gains.p_gain_ + gains.i_gain_ / s + gains.d_gain_ * s;
+}
+
+void computeLoopResponse(
+  const FrequencyResponse & plant, const Pid::Gains & gains, FrequencyResponse & loop)
+{
+  loop.sample_rate = plant.sample_rate;
+  loop.frequencies = plant.frequencies;
+  loop.coherence = plant.coherence;
+  loop.response.resize(plant.response.size());
+  for (std::size_t k = 0; k < plant.response.size(); ++k) {
+    loop.response[k] =
+      evaluatePidResponse(gains, plant.frequencies[k], plant.sample_rate) * plant.response[k];
+  }
+}
+
+bool computeStabilityMargins(const FrequencyResponse & loop, StabilityMargins & margins)
+{
+  const std::size_t n = std::min(loop.frequencies.size(), loop.response.size());
+  if (n < 2) {
+    return false;
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  margins.gain_margin = inf;
+  margins.phase_margin = inf;
+  margins.gain_crossover_frequency = 0.0;
+  margins.phase_crossover_frequency = 0.0;
+  margins.bandwidth = inf;
+
+  // Unwrap the phase along the grid, in degrees
+  std::vector<double> phase(n);
+  phase[0] = std::arg(loop.response[0]) * 180.0 / M_PI;
+  for (std::size_t k = 1; k < n; ++k) {
+    double step = std::arg(loop.response[k] / loop.response[k - 1]);
+    phase[k] = phase[k - 1] + (std::isfinite(step) ? step * 180.0 / M_PI : 0.0);
+  }
+
+  const double reference = std::abs(loop.response[0] / (1.0 + loop.response[0]));
+  bool bandwidth_found = false;
+
+  for (std::size_t k = 1; k < n; ++k) {
+    const double f0 = loop.frequencies[k - 1];
+    const double f1 = loop.frequencies[k];
+    const double mag0 = std::log(std::abs(loop.response[k - 1]));
+    const double mag1 = std::log(std::abs(loop.response[k]));
+
+    // Gain crossover: |L| crosses 1
+    if ((mag0 >= 0.0) != (mag1 >= 0.0)) {
+      const double f = interpolateFrequency(f0, f1, mag0, mag1, 0.0);
+      const double ratio = (mag1 != mag0) ? (0.0 - mag0) / (mag1 - mag0) : 0.0;
+      const double crossover_phase = phase[k - 1] + ratio * (phase[k] - phase[k - 1]);
+      const double pm = std::remainder(180.0 + crossover_phase, 360.0);
+      if (pm < margins.phase_margin) {
+        margins.phase_margin = pm;
+        margins.gain_crossover_frequency = f;
+      }
+    }
+
+    // Phase crossover: the phase crosses an odd multiple of -180 degrees
+    const double branch0 = std::floor((phase[k - 1] + 180.0) / 360.0);
+    const double branch1 = std::floor((phase[k] + 180.0) / 360.0);
+    if (branch0 != branch1) {
+      const double target = 360.0 * std::max(branch0, branch1) - 180.0;
+      const double f = interpolateFrequency(f0, f1, phase[k - 1], phase[k], target);
+      const double ratio = (target - phase[k - 1]) / (phase[k] - phase[k - 1]);
+      const double gm = std::exp(-(mag0 + ratio * (mag1 - mag0)));
+      if (gm < margins.gain_margin) {
+        margins.gain_margin = gm;
+        margins.phase_crossover_frequency = f;
+      }
+    }
+
+    // Closed loop bandwidth
+    if (!bandwidth_found) {
+      const double closed0 = std::abs(loop.response[k - 1] / (1.0 + loop.response[k - 1]));
+      const double closed1 = std::abs(loop.response[k] / (1.0 + loop.response[k]));
+      const double threshold = reference / std::sqrt(2.0);
+      if (closed1 < threshold) {
+        margins.bandwidth = interpolateFrequency(f0, f1, closed0, closed1, threshold);
+        bandwidth_found = true;
+      }
+    }
+  }
+
+  return true;
+}
+
+}  // namespace control_toolbox
@@ -0,0 +1,242 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/friction_compensation.hpp"
+
+namespace control_toolbox
+{
+double computeFrictionForce(const FrictionParameters & parameters, double velocity)
+{
+  if (velocity == 0.0) {
+    return 0.0;
+  }
+  double stribeck = 0.0;
+  if (parameters.stribeck_velocity > 0.0) {
+    const double ratio = velocity / parameters.stribeck_velocity;
+    stribeck = (parameters.static_friction - parameters.coulomb) * exp(-ratio * ratio);
+  }
+  const double sign = velocity > 0.0 ? 1.0 : -1.0;
+  return sign * (parameters.coulomb + stribeck) + parameters.viscous * velocity;
+}
+
+FrictionIdentifier::FrictionIdentifier()
+: candidates_(), equations_(), num_samples_(0), velocity_deadband_(0.0), initialized_(false)
+{
+}
+
+bool FrictionIdentifier::init(
+  double min_stribeck_velocity, double max_stribeck_velocity, double velocity_deadband)
+{
+  if (
+    min_stribeck_velocity <= 0.0 || max_stribeck_velocity < min_stribeck_velocity ||
+    velocity_deadband < 0.0) {
+    RCUTILS_LOG_ERROR(
+      "Friction identification needs 0 < min_stribeck_velocity <= max_stribeck_velocity and a "
+      "non-negative velocity deadband.");
+    return false;
+  }
+
+  const double ratio = max_stribeck_velocity / min_stribeck_velocity;
+  for (std::size_t i = 0; i < NUM_CANDIDATES; ++i) {
+    candidates_[i] =
+      min_stribeck_velocity * pow(ratio, static_cast<double>(i) / (NUM_CANDIDATES - 1));
+  }
+  velocity_deadband_ = velocity_deadband;
+  initialized_ = true;
+  reset();
+
+  return true;
+}
+
+void FrictionIdentifier::reset()
+{
+  for (auto & equations : equations_) {
+    equations.ata.fill(0.0);
+    equations.atb.fill(0.0);
+    equations.btb = 0.0;
+  }
+  num_samples_ = 0;
+}
+
+void FrictionIdentifier::addSample(double velocity, double force, double weight)
+{
+  if (
+    !initialized_ || !std::isfinite(velocity) || !std::isfinite(force) || weight <= 0.0 ||
+    velocity == 0.0 || std::abs(velocity) <= velocity_deadband_) {
+    return;
+  }
+
+  const double sign = velocity > 0.0 ? 1.0 : -1.0;
+  for (std::size_t c = 0; c < NUM_CANDIDATES; ++c) {
+    const double ratio = velocity / candidates_[c];
+    const double stribeck = exp(-ratio * ratio);
+    const std::array<double, 3> regressor = {sign * (1.0 - stribeck), sign * stribeck, velocity};
+
+    NormalEquations & equations = equations_[c];
+    for (std::size_t i = 0; i < 3; ++i) {
+      const double weighted = weight * regressor[i];
+      for (std::size_t j = 0; j < 3; ++j) {
+        equations.ata[3 * i + j] += weighted * regressor[j];
+      }
+      equations.atb[i] += weighted * force;
+    }
+    equations.btb += weight * force * force;
+  }
+  ++num_samples_;
+}
+
+bool FrictionIdentifier::fit(FrictionParameters & parameters) const
+{
+  if (!initialized_ || num_samples_ == 0) {
+    return false;
+  }
+
+  double best_residual = std::numeric_limits<double>::infinity();
+  for (std::size_t c = 0; c < NUM_CANDIDATES; ++c) {
+    const NormalEquations & equations = equations_[c];
+
+    // Solve the regularized normal equations by Gaussian elimination with partial pivoting,
+    // the regularization keeps the Stribeck term bounded when no slow sample is available
+    std::array<double, 9> a = equations.ata;
+    std::array<double, 3> x = equations.atb;
+    const double regularization = 1e-9 * (a[0] + a[4] + a[8]);
+    for (std::size_t i = 0; i < 3; ++i) {
+      a[3 * i + i] += regularization;
+    }
+    for (std::size_t col = 0; col < 3; ++col) {
+      std::size_t pivot = col;
+      for (std::size_t row = col + 1; row < 3; ++row) {
+        if (std::abs(a[3 * row + col]) > std::abs(a[3 * pivot + col])) {
+          pivot = row;
+        }
+      }
+      if (a[3 * pivot + col] == 0.0) {
+        continue;
+      }
+      if (pivot != col) {
+        for (std::size_t j = 0; j < 3; ++j) {
+          std::swap(a[3 * col + j], a[3 * pivot + j]);
+        }
+        std::swap(x[col], x[pivot]);
+      }
+      for (std::size_t row = col + 1; row < 3; ++row) {
+        const double factor = a[3 * row + col] / a[3 * col + col];
+        for (std::size_t j = col; j < 3; ++j) {
+          a[3 * row + j] -= factor * a[3 * col + j];
+        }
+        x[row] -= factor * x[col];
+      }
+    }
+    for (std::size_t i = 3; i-- > 0;) {
+      for (std::size_t j = i + 1; j < 3; ++j) {
+        x[i] -= a[3 * i + j] * x[j];
+      }
+      x[i] = a[3 * i + i] != 0.0 ? x[i] / a[3 * i + i] : 0.0;
+    }
+
+    // Residual sum of squares at the least squares solution
+    double residual = equations.btb;
+    for (std::size_t i = 0; i < 3; ++i) {
+      residual -= x[i] * equations.atb[i];
+    }
+
+    if (residual < best_residual) {
+      best_residual = residual;
+      parameters.coulomb = x[0];
+      parameters.static_friction = x[1];
+      parameters.viscous = x[2];
+      parameters.stribeck_velocity = candidates_[c];
+    }
+  }
+
+  return true;
+}
+
+std::size_t FrictionIdentifier::getNumSamples() const { return num_samples_; }
+
+FrictionCompensator::FrictionCompensator() : max_velocity_(0.0), inverse_step_(0.0) {}
+
+bool FrictionCompensator::init(
+  const FrictionParameters & parameters, double max_velocity, std::size_t table_size,
+  double velocity_deadband)
+{
+  if (max_velocity <= 0.0 || table_size < 3 || velocity_deadband < 0.0) {
+    RCUTILS_LOG_ERROR(
+      "Friction compensation needs max_velocity > 0, at least 3 grid points and a non-negative "
+      "velocity deadband.");
+    return false;
+  }
+
+  parameters_ = parameters;
+  max_velocity_ = max_velocity;
+  inverse_step_ = (table_size - 1) / (2.0 * max_velocity);
+
+  // Force at the edges of the ramp around zero velocity
+  const double ramp_force = computeFrictionForce(parameters, velocity_deadband);
+
+  table_.resize(table_size);
+  for (std::size_t i = 0; i < table_size; ++i) {
+    const double velocity = -max_velocity + i / inverse_step_;
+    if (std::abs(velocity) < velocity_deadband) {
+      table_[i] = ramp_force * velocity / velocity_deadband;
+    } else {
+      table_[i] = computeFrictionForce(parameters, velocity);
+    }
+  }
+
+  return true;
+}
+
+double FrictionCompensator::compute(double velocity) const
+{
+  if (table_.empty() || std::isnan(velocity)) {
+    return 0.0;
+  }
+  if (std::abs(velocity) >= max_velocity_) {
+    return computeFrictionForce(parameters_, velocity);
+  }
+
+  const double position = (velocity + max_velocity_) * inverse_step_;
+  const std::size_t index = std::min(static_cast<std::size_t>(position), table_.size() - 2);
+  const double fraction = position - index;
+  return table_[index] + fraction * (table_[index + 1] - table_[index]);
+}
+
+}  // namespace control_toolbox
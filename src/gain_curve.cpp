@@ -0,0 +1,147 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/gain_curve.hpp"
+
+namespace control_toolbox
+{
+GainCurve::GainCurve() : polynomial_(false), inverse_cell_width_(0.0), max_error_(0.0) {}
+
+std::shared_ptr<const GainCurve> GainCurve::createPiecewiseLinear(
+  const std::vector<double> & errors, const std::vector<double> & scales)
+{
+  if (errors.empty() || errors.size() != scales.size() || !(errors.front() >= 0.0)) {
+    RCUTILS_LOG_ERROR("Gain curve needs one scale per non negative breakpoint.");
+    return nullptr;
+  }
+  double min_spacing = std::numeric_limits<double>::infinity();
+  for (std::size_t k = 0; k < errors.size(); ++k) {
+    if (!std::isfinite(errors[k]) || !std::isfinite(scales[k])) {
+      RCUTILS_LOG_ERROR("Gain curve breakpoints must be finite.");
+      return nullptr;
+    }
+    if (k > 0) {
+      if (!(errors[k] > errors[k - 1])) {
+        RCUTILS_LOG_ERROR("Gain curve breakpoints must be strictly increasing.");
+        return nullptr;
+      }
+      min_spacing = std::min(min_spacing, errors[k] - errors[k - 1]);
+    }
+  }
+
+  // Cells no wider than the closest breakpoints hold at most one breakpoint each, so evaluate
+  // steps over at most one breakpoint from the start of a cell
+  const double range = errors.back() - errors.front();
+  const double num_cells = errors.size() > 1 ? std::ceil(range / min_spacing) + 1 : 0.0;
+  if (num_cells > MAX_GRID_CELLS) {
+    RCUTILS_LOG_ERROR(
+      "Gain curve breakpoints are too close for their range, the closest must be at least "
+      "%g apart.",
+      range / (MAX_GRID_CELLS - 1));
+    return nullptr;
+  }
+
+  std::shared_ptr<GainCurve> curve(new GainCurve());
+  curve->errors_ = errors;
+  curve->scales_ = scales;
+  curve->slopes_.resize(errors.size(), 0.0);
+  for (std::size_t k = 0; k + 1 < errors.size(); ++k) {
+    curve->slopes_[k] = (scales[k + 1] - scales[k]) / (errors[k + 1] - errors[k]);
+  }
+
+  if (errors.size() > 1) {
+    const auto cells = static_cast<std::size_t>(num_cells);
+    curve->inverse_cell_width_ = cells / range;
+    curve->grid_.resize(cells + 1);
+    std::size_t segment = 0;
+    for (std::size_t cell = 0; cell <= cells; ++cell) {
+      const double start = errors.front() + cell / curve->inverse_cell_width_;
+      while (segment + 2 < errors.size() && errors[segment + 1] <= start) {
+        ++segment;
+      }
+      curve->grid_[cell] = segment;
+    }
+  }
+  return curve;
+}
+
+std::shared_ptr<const GainCurve> GainCurve::createPolynomial(
+  const std::vector<double> & coefficients, double max_error)
+{
+  if (coefficients.empty() || !(max_error > 0.0)) {
+    RCUTILS_LOG_ERROR("Gain curve polynomial needs coefficients and a positive range.");
+    return nullptr;
+  }
+  std::shared_ptr<GainCurve> curve(new GainCurve());
+  curve->polynomial_ = true;
+  curve->coefficients_ = coefficients;
+  curve->max_error_ = max_error;
+  return curve;
+}
+
+double GainCurve::evaluate(double error) const
+{
+  const double x = std::abs(error);
+
+  if (polynomial_) {
+    const double clamped = std::min(x, max_error_);
+    double value = 0.0;
+    for (auto c = coefficients_.rbegin(); c != coefficients_.rend(); ++c) {
+      value = value * clamped + *c;
+    }
+    return value;
+  }
+
+  if (!(x > errors_.front())) {
+    return scales_.front();
+  }
+  if (x >= errors_.back()) {
+    return scales_.back();
+  }
+
+  const auto cell = static_cast<std::size_t>((x - errors_.front()) * inverse_cell_width_);
+  std::size_t segment = grid_[cell];
+  while (x >= errors_[segment + 1]) {
+    ++segment;
+  }
+  return scales_[segment] + slopes_[segment] * (x - errors_[segment]);
+}
+
+}  // namespace control_toolbox
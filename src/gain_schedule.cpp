@@ -0,0 +1,353 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CONTROL_TOOLBOX_HAS_MMAP
+#endif
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/gain_schedule.hpp"
+
+namespace control_toolbox
+{
+namespace
+{
+constexpr uint32_t GAIN_SCHEDULE_MAGIC = 0x53475443;  // "CTGS" in the file
+constexpr uint32_t GAIN_SCHEDULE_VERSION = 1;
+
+// Values stored per breakpoint: p, i, d, i_max, i_min and antiwindup as 0 or 1
+constexpr std::size_t GAIN_FIELDS = 6;
+// Values stored per breakpoint, in the order of LimitedProxyParameters
+constexpr std::size_t PROXY_FIELDS = 11;
+
+/*!
+ * \brief Start of a schedule file, followed by the gain breakpoints, the gains, the proxy
+ *        breakpoints and the proxy parameters
+ */
+struct GainScheduleHeader
+{
+  uint32_t magic;                /**< GAIN_SCHEDULE_MAGIC, also tells the byte order. */
+  uint32_t version;              /**< Layout version. */
+  uint64_t size;                 /**< Size of the file in bytes. */
+  uint64_t checksum;             /**< Checksum of the tables, see checksum(). */
+  uint64_t num_gains;            /**< Number of gain breakpoints. */
+  uint64_t num_proxy_parameters; /**< Number of proxy breakpoints. */
+  uint64_t reserved[3];          /**< Zero, pads the header to 64 bytes. */
+};
+static_assert(sizeof(GainScheduleHeader) == 64, "Unexpected gain schedule header size");
+
+std::size_t tablesSize(uint64_t num_gains, uint64_t num_proxy_parameters)
+{
+  return (num_gains * (1 + GAIN_FIELDS) + num_proxy_parameters * (1 + PROXY_FIELDS)) *
+         sizeof(double);
+}
+
+// FNV-1a over the 64 bit words of the tables
+uint64_t checksum(const unsigned char * data, std::size_t size)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (std::size_t offset = 0; offset < size; offset += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + offset, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+bool validBreakpoints(const double * breakpoints, std::size_t size, const char * table)
+{
+  for (std::size_t k = 0; k < size; ++k) {
+    if (!std::isfinite(breakpoints[k]) || (k > 0 && !(breakpoints[k] > breakpoints[k - 1]))) {
+      RCUTILS_LOG_ERROR(
+        "Gain schedule %s breakpoints must be finite and strictly increasing.", table);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool validValues(const double * values, std::size_t size, const char * table)
+{
+  for (std::size_t k = 0; k < size; ++k) {
+    if (!std::isfinite(values[k])) {
+      RCUTILS_LOG_ERROR("Gain schedule %s must be finite.", table);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Index of the last breakpoint not above value, 0 below the first one
+std::size_t findSegment(const double * breakpoints, std::size_t size, double value)
+{
+  const double * upper = std::upper_bound(breakpoints, breakpoints + size, value);
+  return upper == breakpoints ? 0 : static_cast<std::size_t>(upper - breakpoints) - 1;
+}
+}  // namespace
+
+void LimitedProxyParameters::applyTo(LimitedProxy & proxy) const
+{
+  proxy.mass_ = mass;
+  proxy.Kd_ = Kd;
+  proxy.Kp_ = Kp;
+  proxy.Ki_ = Ki;
+  proxy.Ficl_ = Ficl;
+  proxy.effort_limit_ = effort_limit;
+  proxy.vel_limit_ = vel_limit;
+  proxy.pos_upper_limit_ = pos_upper_limit;
+  proxy.pos_lower_limit_ = pos_lower_limit;
+  proxy.lambda_proxy_ = lambda_proxy;
+  proxy.acc_converge_ = acc_converge;
+}
+
+GainSchedule::GainSchedule()
+: memory_(nullptr),
+  size_(0),
+  num_gains_(0),
+  num_proxy_parameters_(0),
+  gain_breakpoints_(nullptr),
+  gains_(nullptr),
+  proxy_breakpoints_(nullptr),
+  proxy_parameters_(nullptr)
+{
+}
+
+GainSchedule::~GainSchedule()
+{
+#ifdef CONTROL_TOOLBOX_HAS_MMAP
+  if (memory_ != nullptr) {
+    munmap(memory_, size_);
+  }
+#endif
+}
+
+bool GainSchedule::write(
+  const std::string & path, const std::vector<double> & gain_breakpoints,
+  const std::vector<Pid::Gains> & gains, const std::vector<double> & proxy_breakpoints,
+  const std::vector<LimitedProxyParameters> & proxy_parameters)
+{
+  if (
+    gain_breakpoints.size() != gains.size() ||
+    proxy_breakpoints.size() != proxy_parameters.size() ||
+    (gains.empty() && proxy_parameters.empty())) {
+    RCUTILS_LOG_ERROR("Gain schedule needs one set of values per breakpoint.");
+    return false;
+  }
+
+  // Lay the file out in memory, then validate it as load() does
+  std::vector<double> tables;
+  tables.reserve(tablesSize(gains.size(), proxy_parameters.size()) / sizeof(double));
+  tables.insert(tables.end(), gain_breakpoints.begin(), gain_breakpoints.end());
+  for (const auto & g : gains) {
+    tables.insert(
+      tables.end(), {g.p_gain_, g.i_gain_, g.d_gain_, g.i_max_, g.i_min_,
+                     g.antiwindup_ ? 1.0 : 0.0});
+  }
+  tables.insert(tables.end(), proxy_breakpoints.begin(), proxy_breakpoints.end());
+  for (const auto & p : proxy_parameters) {
+    tables.insert(
+      tables.end(), {p.mass, p.Kd, p.Kp, p.Ki, p.Ficl, p.effort_limit, p.vel_limit,
+                     p.pos_upper_limit, p.pos_lower_limit, p.lambda_proxy, p.acc_converge});
+  }
+  const double * gain_values = tables.data() + gains.size();
+  const double * proxy_values = gain_values + gains.size() * GAIN_FIELDS + proxy_breakpoints.size();
+  if (
+    !validBreakpoints(gain_breakpoints.data(), gain_breakpoints.size(), "gain") ||
+    !validBreakpoints(proxy_breakpoints.data(), proxy_breakpoints.size(), "proxy") ||
+    !validValues(gain_values, gains.size() * GAIN_FIELDS, "gains") ||
+    !validValues(proxy_values, proxy_parameters.size() * PROXY_FIELDS, "proxy parameters")) {
+    return false;
+  }
+
+  GainScheduleHeader header{};
+  header.magic = GAIN_SCHEDULE_MAGIC;
+  header.version = GAIN_SCHEDULE_VERSION;
+  header.size = sizeof(GainScheduleHeader) + tables.size() * sizeof(double);
+  header.num_gains = gains.size();
+  header.num_proxy_parameters = proxy_parameters.size();
+  const auto data = reinterpret_cast<const unsigned char *>(tables.data());
+  header.checksum = checksum(data, tables.size() * sizeof(double));
+
+  const std::string temporary = path + ".tmp";
+  std::FILE * file = std::fopen(temporary.c_str(), "wb");
+  if (file == nullptr) {
+    RCUTILS_LOG_ERROR("Could not create gain schedule %s.", temporary.c_str());
+    return false;
+  }
+  const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                       std::fwrite(tables.data(), sizeof(double), tables.size(), file) ==
+                         tables.size();
+  if (std::fclose(file) != 0 || !written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    RCUTILS_LOG_ERROR("Could not write gain schedule %s.", path.c_str());
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::shared_ptr<const GainSchedule> GainSchedule::load(const std::string & path)
+{
+#ifdef CONTROL_TOOLBOX_HAS_MMAP
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    RCUTILS_LOG_ERROR("Could not open gain schedule %s.", path.c_str());
+    return nullptr;
+  }
+  struct stat status;
+  void * memory = MAP_FAILED;
+  if (
+    fstat(fd, &status) == 0 &&
+    static_cast<std::size_t>(status.st_size) >= sizeof(GainScheduleHeader)) {
+    memory = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    RCUTILS_LOG_ERROR("Could not map gain schedule %s.", path.c_str());
+    return nullptr;
+  }
+
+  // Owns the mapping from now on, also when the file turns out invalid
+  std::shared_ptr<GainSchedule> schedule(new GainSchedule());
+  schedule->memory_ = memory;
+  schedule->size_ = static_cast<std::size_t>(status.st_size);
+
+  const auto header = static_cast<const GainScheduleHeader *>(memory);
+  if (header->magic != GAIN_SCHEDULE_MAGIC || header->version != GAIN_SCHEDULE_VERSION) {
+    RCUTILS_LOG_ERROR("%s is not a gain schedule of version %u.", path.c_str(),
+                      GAIN_SCHEDULE_VERSION);
+    return nullptr;
+  }
+  // Bound the counts before computing sizes from them
+  const uint64_t max_count = schedule->size_ / sizeof(double);
+  if (
+    header->size != schedule->size_ || header->num_gains > max_count ||
+    header->num_proxy_parameters > max_count ||
+    header->size !=
+      sizeof(GainScheduleHeader) + tablesSize(header->num_gains, header->num_proxy_parameters)) {
+    RCUTILS_LOG_ERROR("Gain schedule %s is truncated or has inconsistent sizes.", path.c_str());
+    return nullptr;
+  }
+  const auto tables = static_cast<const unsigned char *>(memory) + sizeof(GainScheduleHeader);
+  if (checksum(tables, schedule->size_ - sizeof(GainScheduleHeader)) != header->checksum) {
+    RCUTILS_LOG_ERROR("Gain schedule %s is corrupted, its checksum does not match.", path.c_str());
+    return nullptr;
+  }
+
+  schedule->num_gains_ = header->num_gains;
+  schedule->num_proxy_parameters_ = header->num_proxy_parameters;
+  schedule->gain_breakpoints_ = reinterpret_cast<const double *>(tables);
+  schedule->gains_ = schedule->gain_breakpoints_ + schedule->num_gains_;
+  schedule->proxy_breakpoints_ = schedule->gains_ + schedule->num_gains_ * GAIN_FIELDS;
+  schedule->proxy_parameters_ = schedule->proxy_breakpoints_ + schedule->num_proxy_parameters_;
+  if (
+    (schedule->num_gains_ == 0 && schedule->num_proxy_parameters_ == 0) ||
+    !validBreakpoints(schedule->gain_breakpoints_, schedule->num_gains_, "gain") ||
+    !validBreakpoints(
+      schedule->proxy_breakpoints_, schedule->num_proxy_parameters_, "proxy") ||
+    !validValues(schedule->gains_, schedule->num_gains_ * GAIN_FIELDS, "gains") ||
+    !validValues(
+      schedule->proxy_parameters_, schedule->num_proxy_parameters_ * PROXY_FIELDS,
+      "proxy parameters")) {
+    return nullptr;
+  }
+  return schedule;
+#else
+  RCUTILS_LOG_ERROR(
+    "Gain schedule %s needs memory mapped files, not available on this platform.", path.c_str());
+  return nullptr;
+#endif
+}
+
+std::size_t GainSchedule::getNumGains() const { return num_gains_; }
+
+std::size_t GainSchedule::getNumProxyParameters() const { return num_proxy_parameters_; }
+
+Pid::Gains GainSchedule::getGains(double value) const
+{
+  if (num_gains_ == 0) {
+    return Pid::Gains();
+  }
+
+  const std::size_t k = findSegment(gain_breakpoints_, num_gains_, value);
+  const double * lower = gains_ + k * GAIN_FIELDS;
+  double g[GAIN_FIELDS];
+  if (k + 1 == num_gains_ || !(value > gain_breakpoints_[k])) {
+    std::copy(lower, lower + GAIN_FIELDS, g);
+  } else {
+    const double * upper = lower + GAIN_FIELDS;
+    const double t =
+      (value - gain_breakpoints_[k]) / (gain_breakpoints_[k + 1] - gain_breakpoints_[k]);
+    for (std::size_t f = 0; f < GAIN_FIELDS; ++f) {
+      g[f] = lower[f] + t * (upper[f] - lower[f]);
+    }
+  }
+  return Pid::Gains(g[0], g[1], g[2], g[3], g[4], lower[5] != 0.0);
+}
+
+LimitedProxyParameters GainSchedule::getProxyParameters(double value) const
+{
+  LimitedProxyParameters parameters;
+  if (num_proxy_parameters_ == 0) {
+    return parameters;
+  }
+
+  const std::size_t k = findSegment(proxy_breakpoints_, num_proxy_parameters_, value);
+  const double * values = proxy_parameters_ + k * PROXY_FIELDS;
+  parameters.mass = values[0];
+  parameters.Kd = values[1];
+  parameters.Kp = values[2];
+  parameters.Ki = values[3];
+  parameters.Ficl = values[4];
+  parameters.effort_limit = values[5];
+  parameters.vel_limit = values[6];
+  parameters.pos_upper_limit = values[7];
+  parameters.pos_lower_limit = values[8];
+  parameters.lambda_proxy = values[9];
+  parameters.acc_converge = values[10];
+  return parameters;
+}
+
+}  // namespace control_toolbox
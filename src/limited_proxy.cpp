@@ -35,6 +35,7 @@
 #include <cstdlib>
 
 #include "control_toolbox/limited_proxy.hpp"
+#include "control_toolbox/tracing.hpp"
 
 namespace control_toolbox
 {
@@ -142,6 +143,8 @@ void LimitedProxy::reset(double pos_act, double vel_act)
 double LimitedProxy::update(
   double pos_des, double vel_des, double acc_des, double pos_act, double vel_act, double dt)
 {
+  CONTROL_TOOLBOX_TRACEPOINT4(limited_proxy_update_entry, pos_des, vel_des, pos_act, dt);
+
   // Get the parameters.  This ensures that they can not change during
   // the calculations and are non-negative!
   double mass = abs(mass_);          // Estimate of the joint mass
@@ -412,6 +415,7 @@ double LimitedProxy::update(
   last_int_error_ = int_err;
 
   // (c) Return the controller force.
+  CONTROL_TOOLBOX_TRACEPOINT3(limited_proxy_update_exit, force, pos_pxy, int_err);
   return force;
 }
 
@@ -0,0 +1,230 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/notch_filter.hpp"
+
+namespace control_toolbox
+{
+std::complex<double> BiquadCoefficients::response(double frequency, double sample_rate) const
+{
+  const std::complex<double> z_inv = std::polar(1.0, -2.0 * M_PI * frequency / sample_rate);
+  return (b0 + z_inv * (b1 + z_inv * b2)) / (1.0 + z_inv * (a1 + z_inv * a2));
+}
+
+BiquadCoefficients designNotch(double frequency, double width, double depth, double sample_rate)
+{
+  BiquadCoefficients coefficients;
+  if (
+    sample_rate <= 0.0 || frequency <= 0.0 || frequency >= 0.5 * sample_rate || width <= 0.0 ||
+    depth < 0.0 || depth >= 1.0) {
+    RCUTILS_LOG_ERROR("Notch parameters out of range, using a pass-through section instead.");
+    return coefficients;
+  }
+
+  // Prewarp the center frequency and apply the bilinear transform s = c (1 - z^-1) / (1 + z^-1)
+  const double c = 2.0 * sample_rate;
+  const double w = c * tan(M_PI * frequency / sample_rate);
+  const double zeta = width / (2.0 * frequency);
+  const double c2 = c * c;
+  const double w2 = w * w;
+  const double num_damping = 2.0 * depth * zeta * w * c;
+  const double den_damping = 2.0 * zeta * w * c;
+
+  const double a0 = c2 + den_damping + w2;
+  coefficients.b0 = (c2 + num_damping + w2) / a0;
+  coefficients.b1 = (2.0 * w2 - 2.0 * c2) / a0;
+  coefficients.b2 = (c2 - num_damping + w2) / a0;
+  coefficients.a1 = (2.0 * w2 - 2.0 * c2) / a0;
+  coefficients.a2 = (c2 - den_damping + w2) / a0;
+  return coefficients;
+}
+
+std::vector<Resonance> detectResonances(
+  const FrequencyResponse & response, double min_prominence, std::size_t max_resonances)
+{
+  std::vector<Resonance> resonances;
+  const std::size_t n = std::min(response.frequencies.size(), response.response.size());
+  if (n < 3) {
+    return resonances;
+  }
+
+  std::vector<double> magnitude(n);
+  for (std::size_t k = 0; k < n; ++k) {
+    magnitude[k] = 20.0 * log10(std::abs(response.response[k]));
+  }
+
+  for (std::size_t k = 1; k + 1 < n; ++k) {
+    if (!(magnitude[k] > magnitude[k - 1] && magnitude[k] >= magnitude[k + 1])) {
+      continue;
+    }
+    const double peak = magnitude[k];
+
+    // Lowest point on each side before the magnitude rises above the peak
+    double left_min = peak;
+    for (std::size_t i = k; i-- > 0 && magnitude[i] <= peak;) {
+      left_min = std::min(left_min, magnitude[i]);
+    }
+    double right_min = peak;
+    for (std::size_t i = k + 1; i < n && magnitude[i] <= peak; ++i) {
+      right_min = std::min(right_min, magnitude[i]);
+    }
+
+    Resonance resonance;
+    resonance.frequency = response.frequencies[k];
+    resonance.prominence = peak - std::max(left_min, right_min);
+    if (resonance.prominence < min_prominence) {
+      continue;
+    }
+
+    // Half power points, interpolated between grid points
+    const double half_power = peak - 3.0;
+    double low = response.frequencies.front();
+    for (std::size_t i = k; i-- > 0;) {
+      if (magnitude[i] < half_power) {
+        const double ratio = (half_power - magnitude[i]) / (magnitude[i + 1] - magnitude[i]);
+        low = response.frequencies[i] +
+              ratio * (response.frequencies[i + 1] - response.frequencies[i]);
+        break;
+      }
+    }
+    double high = response.frequencies[n - 1];
+    for (std::size_t i = k + 1; i < n; ++i) {
+      if (magnitude[i] < half_power) {
+        const double ratio = (magnitude[i - 1] - half_power) / (magnitude[i - 1] - magnitude[i]);
+        high = response.frequencies[i - 1] +
+               ratio * (response.frequencies[i] - response.frequencies[i - 1]);
+        break;
+      }
+    }
+    resonance.width = high - low;
+
+    resonances.push_back(resonance);
+  }
+
+  std::sort(resonances.begin(), resonances.end(), [](const Resonance & a, const Resonance & b) {
+    return a.prominence > b.prominence;
+  });
+  if (resonances.size() > max_resonances) {
+    resonances.resize(max_resonances);
+  }
+  return resonances;
+}
+
+std::vector<BiquadCoefficients> designNotches(
+  const std::vector<Resonance> & resonances, double sample_rate, double width_scale)
+{
+  std::vector<BiquadCoefficients> sections;
+  for (const auto & resonance : resonances) {
+    if (sections.size() == NotchFilter::MAX_SECTIONS) {
+      break;
+    }
+    if (resonance.frequency >= 0.5 * sample_rate || resonance.width <= 0.0) {
+      continue;
+    }
+    // Invert a second order mode: the poles of the notch take the damping of the zeros of the
+    // mode, which is the damping of its poles (the -3 dB width) times the height of the peak
+    const double depth = pow(10.0, -resonance.prominence / 20.0);
+    const double width = width_scale * resonance.width / depth;
+    sections.push_back(designNotch(resonance.frequency, width, depth, sample_rate));
+  }
+  return sections;
+}
+
+NotchFilter::NotchFilter() : coefficients_buffer_(), revision_(0), applied_revision_(0)
+{
+  reset();
+}
+
+NotchFilter::NotchFilter(const NotchFilter & source)
+: revision_(source.revision_), applied_revision_(0)
+{
+  // Copy the realtime buffer to the new filter
+  coefficients_buffer_ = source.coefficients_buffer_;
+
+  // Reset the state of the new filter
+  reset();
+}
+
+bool NotchFilter::setCoefficients(const std::vector<BiquadCoefficients> & sections)
+{
+  if (sections.size() > MAX_SECTIONS) {
+    RCUTILS_LOG_ERROR("Too many notch sections, at most %zu are supported.", MAX_SECTIONS);
+    return false;
+  }
+
+  Coefficients coefficients;
+  std::copy(sections.begin(), sections.end(), coefficients.sections.begin());
+  coefficients.num_sections = sections.size();
+  coefficients.revision = ++revision_;
+  coefficients_buffer_.writeFromNonRT(coefficients);
+  return true;
+}
+
+double NotchFilter::update(double input)
+{
+  const Coefficients & coefficients = *coefficients_buffer_.readFromRT();
+
+  if (coefficients.revision != applied_revision_) {
+    // Clear the sections that are not used anymore, so they start clean when reused
+    for (std::size_t s = coefficients.num_sections; s < MAX_SECTIONS; ++s) {
+      state_[s] = {0.0, 0.0};
+    }
+    applied_revision_ = coefficients.revision;
+  }
+
+  double x = input;
+  for (std::size_t s = 0; s < coefficients.num_sections; ++s) {
+    const BiquadCoefficients & c = coefficients.sections[s];
+    std::array<double, 2> & z = state_[s];
+    const double y = c.b0 * x + z[0];
+    z[0] = c.b1 * x - c.a1 * y + z[1];
+    z[1] = c.b2 * x - c.a2 * y;
+    x = y;
+  }
+  return x;
+}
+
+void NotchFilter::reset()
+{
+  for (auto & z : state_) {
+    z = {0.0, 0.0};
+  }
+}
+
+}  // namespace control_toolbox
@@ -0,0 +1,111 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <limits>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/filters.hpp"
+#include "control_toolbox/online_trajectory_generator.hpp"
+
+namespace control_toolbox
+{
+OnlineTrajectoryGenerator::OnlineTrajectoryGenerator()
+: max_velocity_(std::numeric_limits<double>::infinity()),
+  max_acceleration_(std::numeric_limits<double>::infinity()),
+  position_(0.0),
+  velocity_(0.0),
+  acceleration_(0.0)
+{
+}
+
+bool OnlineTrajectoryGenerator::init(double max_velocity, double max_acceleration)
+{
+  if (!(max_velocity > 0.0) || !(max_acceleration > 0.0)) {
+    RCUTILS_LOG_ERROR("Online trajectory generator limits must be strictly positive.");
+    return false;
+  }
+  max_velocity_ = max_velocity;
+  max_acceleration_ = max_acceleration;
+  return true;
+}
+
+void OnlineTrajectoryGenerator::reset(double position, double velocity)
+{
+  position_ = position;
+  velocity_ = velocity;
+  acceleration_ = 0.0;
+}
+
+double OnlineTrajectoryGenerator::update(
+  double target_position, double target_velocity, double dt, double & velocity,
+  double & acceleration)
+{
+  if (dt > 0.0 && std::isfinite(target_position) && std::isfinite(target_velocity)) {
+    target_velocity = filters::clamp(target_velocity, -max_velocity_, max_velocity_);
+
+    // Distance to the target left after this cycle when moving along with it
+    const double error = target_position - position_ - target_velocity * dt;
+    const double distance = std::abs(error);
+
+    // Relative velocity from which the target is reached in n braking steps, each one lowering it
+    // by a * dt, where the distance covered is a * dt^2 * n * (n + 1) / 2
+    const double step = max_acceleration_ * dt * dt;
+    double approach_velocity;
+    if (distance <= step) {
+      approach_velocity = distance / dt;
+    } else {
+      const double n = std::sqrt(0.25 + 2.0 * distance / step) - 0.5;
+      approach_velocity = n * max_acceleration_ * dt;
+    }
+
+    const double desired_velocity = filters::clamp(
+      target_velocity + std::copysign(approach_velocity, error), -max_velocity_, max_velocity_);
+    acceleration_ =
+      filters::clamp((desired_velocity - velocity_) / dt, -max_acceleration_, max_acceleration_);
+    velocity_ += acceleration_ * dt;
+    position_ += velocity_ * dt;
+  }
+
+  velocity = velocity_;
+  acceleration = acceleration_;
+  return position_;
+}
+
+double OnlineTrajectoryGenerator::getPosition() const { return position_; }
+
+double OnlineTrajectoryGenerator::getVelocity() const { return velocity_; }
+
+double OnlineTrajectoryGenerator::getAcceleration() const { return acceleration_; }
+
+}  // namespace control_toolbox
@@ -0,0 +1,175 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <array>
+#include <cmath>
+
+#include "control_toolbox/orientation_pid.hpp"
+
+namespace control_toolbox
+{
+Quaternion Quaternion::operator*(const Quaternion & o) const
+{
+  Quaternion q;
+  q.w = w * o.w - x * o.x - y * o.y - z * o.z;
+  q.x = w * o.x + x * o.w + y * o.z - z * o.y;
+  q.y = w * o.y - x * o.z + y * o.w + z * o.x;
+  q.z = w * o.z + x * o.y - y * o.x + z * o.w;
+  return q;
+}
+
+Quaternion Quaternion::conjugate() const
+{
+  Quaternion q;
+  q.w = w;
+  q.x = -x;
+  q.y = -y;
+  q.z = -z;
+  return q;
+}
+
+Vector3 Quaternion::rotate(const Vector3 & v) const
+{
+  // v + 2 u x (u x v + w v), with u the vector part
+  const Vector3 t = {
+    2.0 * (y * v[2] - z * v[1]), 2.0 * (z * v[0] - x * v[2]), 2.0 * (x * v[1] - y * v[0])};
+  return {
+    v[0] + w * t[0] + y * t[2] - z * t[1], v[1] + w * t[1] + z * t[0] - x * t[2],
+    v[2] + w * t[2] + x * t[1] - y * t[0]};
+}
+
+Vector3 Quaternion::log() const
+{
+  // q and -q are the same orientation, take the one with the shortest rotation
+  const double sign = w < 0.0 ? -1.0 : 1.0;
+  const double norm = std::sqrt(x * x + y * y + z * z);
+  double scale;
+  if (norm < 1e-9) {
+    // First order expansion, avoids dividing by the vanishing norm
+    scale = 2.0 / std::abs(w);
+  } else {
+    scale = 2.0 * std::atan2(norm, std::abs(w)) / norm;
+  }
+  return {sign * scale * x, sign * scale * y, sign * scale * z};
+}
+
+Quaternion Quaternion::exp(const Vector3 & rotation)
+{
+  const double angle =
+    std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2]);
+  Quaternion q;
+  if (angle < 1e-9) {
+    q.x = 0.5 * rotation[0];
+    q.y = 0.5 * rotation[1];
+    q.z = 0.5 * rotation[2];
+    return q;
+  }
+  const double scale = std::sin(0.5 * angle) / angle;
+  q.w = std::cos(0.5 * angle);
+  q.x = scale * rotation[0];
+  q.y = scale * rotation[1];
+  q.z = scale * rotation[2];
+  return q;
+}
+
+void OrientationPid::setGains(const Pid::Gains & gains) { setGains({gains, gains, gains}); }
+
+void OrientationPid::setGains(const std::array<Pid::Gains, 3> & gains)
+{
+  pid_.setGains(MimoPid<3>::diagonalGains(gains));
+}
+
+void OrientationPid::setGains(const Gains & gains) { pid_.setGains(gains); }
+
+OrientationPid::Gains OrientationPid::getGains() { return pid_.getGains(); }
+
+void OrientationPid::reset() { pid_.reset(); }
+
+Vector3 OrientationPid::computeCommand(
+  const Quaternion & desired, const Quaternion & actual, const Vector3 & desired_velocity,
+  const Vector3 & actual_velocity, uint64_t dt)
+{
+  const Vector3 error = (desired * actual.conjugate()).log();
+  const Vector3 error_dot = {
+    desired_velocity[0] - actual_velocity[0], desired_velocity[1] - actual_velocity[1],
+    desired_velocity[2] - actual_velocity[2]};
+  return pid_.computeCommand(error, error_dot, dt);
+}
+
+Vector3 OrientationPid::computeCommand(
+  const Quaternion & desired, const Quaternion & actual, uint64_t dt)
+{
+  return pid_.computeCommand((desired * actual.conjugate()).log(), dt);
+}
+
+Vector3 OrientationPid::getError() const
+{
+  Vector3 error, error_dot;
+  pid_.getCurrentErrors(error, error_dot);
+  return error;
+}
+
+void PosePid::setGains(
+  const MimoPid<3>::Gains & translation, const OrientationPid::Gains & rotation)
+{
+  translation_.setGains(translation);
+  rotation_.setGains(rotation);
+}
+
+void PosePid::setGains(const Pid::Gains & translation, const Pid::Gains & rotation)
+{
+  translation_.setGains(MimoPid<3>::diagonalGains({translation, translation, translation}));
+  rotation_.setGains(rotation);
+}
+
+void PosePid::reset()
+{
+  translation_.reset();
+  rotation_.reset();
+}
+
+PosePid::Vector6 PosePid::computeCommand(
+  const Pose & desired, const Pose & actual, const Twist & desired_twist,
+  const Twist & actual_twist, uint64_t dt)
+{
+  Vector3 error, error_dot;
+  for (std::size_t k = 0; k < 3; ++k) {
+    error[k] = desired.position[k] - actual.position[k];
+    error_dot[k] = desired_twist.linear[k] - actual_twist.linear[k];
+  }
+  const Vector3 force = translation_.computeCommand(error, error_dot, dt);
+  const Vector3 torque = rotation_.computeCommand(
+    desired.orientation, actual.orientation, desired_twist.angular, actual_twist.angular, dt);
+  return {force[0], force[1], force[2], torque[0], torque[1], torque[2]};
+}
+
+}  // namespace control_toolbox
@@ -42,24 +42,31 @@
 #include <utility>
 #include <vector>
 
+#include "control_toolbox/gain_schedule.hpp"
 #include "control_toolbox/pid.hpp"
+#include "control_toolbox/pid_math.hpp"
+#include "control_toolbox/tracing.hpp"
 
 namespace control_toolbox
 {
-/// @note replace with std::clamp once its supported
-template <typename T>
-T clamp(T val, T low, T high)
+
+namespace
 {
-  if (val < low) {
-    return low;
-  } else if (val > high) {
-    return high;
-  }
-  return val;
+bool operator!=(const Pid::Gains & a, const Pid::Gains & b)
+{
+  return a.p_gain_ != b.p_gain_ || a.i_gain_ != b.i_gain_ || a.d_gain_ != b.d_gain_ ||
+         a.i_max_ != b.i_max_ || a.i_min_ != b.i_min_ || a.antiwindup_ != b.antiwindup_;
 }
+}  // namespace
 
 Pid::Pid(double p, double i, double d, double i_max, double i_min, bool antiwindup)
-: gains_buffer_()
+: gains_buffer_(),
+  has_gain_curve_(false),
+  has_gain_schedule_(false),
+  schedule_variable_(0.0),
+  error_dot_(0.0),
+  ramp_cycles_(0),
+  state_sequence_(0)
 {
   setGains(p, i, d, i_max, i_min, antiwindup);
 
@@ -67,9 +74,15 @@ Pid::Pid(double p, double i, double d, double i_max, double i_min, bool antiwind
 }
 
 Pid::Pid(const Pid & source)
+: schedule_variable_(source.schedule_variable_), error_dot_(0.0), state_sequence_(0)
 {
   // Copy the realtime buffer to then new PID class
   gains_buffer_ = source.gains_buffer_;
+  gain_curve_buffer_ = source.gain_curve_buffer_;
+  gain_schedule_buffer_ = source.gain_schedule_buffer_;
+  has_gain_curve_ = source.has_gain_curve_.load();
+  has_gain_schedule_ = source.has_gain_schedule_.load();
+  ramp_cycles_ = source.ramp_cycles_.load();
 
   // Reset the state of this PID controller
   reset();
@@ -91,6 +104,16 @@ void Pid::reset()
   i_error_ = 0.0;
   d_error_ = 0.0;
   cmd_ = 0.0;
+
+  // Any ramp in progress ends on the current gains
+  active_schedule_ = readGainSchedule();
+  target_gains_ = *gains_buffer_.readFromRT();
+  active_gains_ =
+    active_schedule_ ? active_schedule_->getGains(schedule_variable_) : target_gains_;
+  applied_gains_ = active_gains_;
+  ramp_remaining_ = 0;
+
+  publishState();
 }
 
 void Pid::getGains(double & p, double & i, double & d, double & i_max, double & i_min)
@@ -114,6 +137,13 @@ void Pid::getGains(
 
 Pid::Gains Pid::getGains() { return *gains_buffer_.readFromRT(); }
 
+Pid::Gains Pid::getGainsNonRT()
+{
+  // The lock keeps the gains from being overwritten while they are copied
+  std::lock_guard<std::mutex> lock(non_rt_mutex_);
+  return *gains_buffer_.readFromNonRT();
+}
+
 void Pid::setGains(double p, double i, double d, double i_max, double i_min, bool antiwindup)
 {
   Gains gains(p, i, d, i_max, i_min, antiwindup);
@@ -121,7 +151,98 @@ void Pid::setGains(double p, double i, double d, double i_max, double i_min, boo
   setGains(gains);
 }
 
-void Pid::setGains(const Gains & gains) { gains_buffer_.writeFromNonRT(gains); }
+void Pid::setGains(const Gains & gains)
+{
+  CONTROL_TOOLBOX_TRACEPOINT3(pid_set_gains_entry, gains.p_gain_, gains.i_gain_, gains.d_gain_);
+  std::lock_guard<std::mutex> lock(non_rt_mutex_);
+  gains_buffer_.writeFromNonRT(gains);
+  CONTROL_TOOLBOX_TRACEPOINT(pid_set_gains_exit);
+}
+
+void Pid::setGainRampCycles(unsigned int cycles) { ramp_cycles_ = cycles; }
+
+unsigned int Pid::getGainRampCycles() const { return ramp_cycles_; }
+
+Pid::Gains Pid::getActiveGains() const { return applied_gains_; }
+
+void Pid::setGainCurve(std::shared_ptr<const GainCurve> curve)
+{
+  std::lock_guard<std::mutex> lock(non_rt_mutex_);
+  gain_curve_buffer_.writeFromNonRT(curve);
+  has_gain_curve_.store(curve != nullptr, std::memory_order_release);
+}
+
+std::shared_ptr<const GainCurve> Pid::getGainCurve()
+{
+  std::lock_guard<std::mutex> lock(non_rt_mutex_);
+  return *gain_curve_buffer_.readFromNonRT();
+}
+
+void Pid::setGainSchedule(std::shared_ptr<const GainSchedule> schedule)
+{
+  std::lock_guard<std::mutex> lock(non_rt_mutex_);
+  gain_schedule_buffer_.writeFromNonRT(schedule);
+  has_gain_schedule_.store(schedule != nullptr, std::memory_order_release);
+}
+
+std::shared_ptr<const GainSchedule> Pid::getGainSchedule()
+{
+  std::lock_guard<std::mutex> lock(non_rt_mutex_);
+  return *gain_schedule_buffer_.readFromNonRT();
+}
+
+void Pid::setScheduleVariable(double value) { schedule_variable_ = value; }
+
+const GainSchedule * Pid::readGainSchedule()
+{
+  if (!has_gain_schedule_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  const GainSchedule * schedule = gain_schedule_buffer_.readFromRT()->get();
+  return (schedule != nullptr && schedule->getNumGains() > 0) ? schedule : nullptr;
+}
+
+const Pid::Gains & Pid::updateActiveGains()
+{
+  // The gains of the schedule, if any, replace the ones of the realtime buffer
+  const GainSchedule * schedule = readGainSchedule();
+  const Gains & gains = *gains_buffer_.readFromRT();
+
+  // A ramp starts when new gains are set or the source of the gains changes, the scheduled
+  // gains follow the scheduling variable without restarting it
+  if (schedule != active_schedule_ || (schedule == nullptr && gains != target_gains_)) {
+    active_schedule_ = schedule;
+    target_gains_ = gains;
+    ramp_remaining_ = ramp_cycles_;
+  }
+  const Gains target = schedule ? schedule->getGains(schedule_variable_) : target_gains_;
+
+  if (ramp_remaining_ == 0) {
+    active_gains_ = target;
+    return active_gains_;
+  }
+
+  const double i_gain_last = active_gains_.i_gain_;
+  const double n = ramp_remaining_;
+  if (--ramp_remaining_ == 0) {
+    active_gains_ = target;
+  } else {
+    // Cover a share of the remaining difference, which ramps linearly toward fixed gains and
+    // still ends on scheduled gains that move during the ramp
+    active_gains_.p_gain_ += (target.p_gain_ - active_gains_.p_gain_) / n;
+    active_gains_.i_gain_ += (target.i_gain_ - active_gains_.i_gain_) / n;
+    active_gains_.d_gain_ += (target.d_gain_ - active_gains_.d_gain_) / n;
+    active_gains_.i_max_ += (target.i_max_ - active_gains_.i_max_) / n;
+    active_gains_.i_min_ += (target.i_min_ - active_gains_.i_min_) / n;
+    active_gains_.antiwindup_ = target.antiwindup_;
+  }
+
+  // Keep the integral term continuous, it cannot be kept through a zero integral gain
+  if (i_gain_last != 0.0 && active_gains_.i_gain_ != 0.0) {
+    i_error_ *= i_gain_last / active_gains_.i_gain_;
+  }
+  return active_gains_;
+}
 
 double Pid::computeCommand(double error, uint64_t dt)
 {
@@ -132,7 +253,7 @@ double Pid::computeCommand(double error, uint64_t dt)
   error_dot_ = d_error_;
 
   // Calculate the derivative error
-  error_dot_ = (error - p_error_last_) / (dt / 1e9);
+  error_dot_ = pid_math::differentiate(error, p_error_last_, dt);
   p_error_last_ = error;
 
   return computeCommand(error, error_dot_, dt);
@@ -140,59 +261,86 @@ double Pid::computeCommand(double error, uint64_t dt)
 
 double Pid::computeCommand(double error, double error_dot, uint64_t dt)
 {
-  // Get the gain parameters from the realtime buffer
-  Gains gains = *gains_buffer_.readFromRT();
+  CONTROL_TOOLBOX_TRACEPOINT3(pid_compute_command_entry, error, error_dot, dt);
 
-  double p_term, d_term, i_term;
   p_error_ = error;  // this is error = target - state
   d_error_ = error_dot;
 
   if (
     dt == 0 || std::isnan(error) || std::isinf(error) || std::isnan(error_dot) ||
     std::isinf(error_dot)) {
+    publishState();
+    CONTROL_TOOLBOX_TRACEPOINT2(pid_compute_command_exit, 0.0, i_error_);
     return 0.0;
   }
 
-  // Calculate proportional contribution to command
-  p_term = gains.p_gain_ * p_error_;
-
-  // Calculate the integral of the position error
-  i_error_ += (dt / 1e9) * p_error_;
+  // Get the gain parameters from the realtime buffer, ramping toward them if configured
+  Gains gains = updateActiveGains();
 
-  if (gains.antiwindup_ && gains.i_gain_ != 0) {
-    // Prevent i_error_ from climbing higher than permitted by i_max_/i_min_
-    std::pair<double, double> bounds =
-      std::minmax<double>(gains.i_min_ / gains.i_gain_, gains.i_max_ / gains.i_gain_);
-    i_error_ = clamp(i_error_, bounds.first, bounds.second);
+  // Scale the proportional gain with the gain curve, if any
+  if (has_gain_curve_.load(std::memory_order_acquire)) {
+    const GainCurve * gain_curve = gain_curve_buffer_.readFromRT()->get();
+    if (gain_curve) {
+      gains.p_gain_ *= gain_curve->evaluate(p_error_);
+    }
   }
+  applied_gains_ = gains;
 
-  // Calculate integral contribution to command
-  i_term = gains.i_gain_ * i_error_;
-
-  if (!gains.antiwindup_) {
-    // Limit i_term so that the limit is meaningful in the output
-    i_term = clamp(i_term, gains.i_min_, gains.i_max_);
-  }
-
-  // Calculate derivative contribution to command
-  d_term = gains.d_gain_ * d_error_;
-
-  // Compute the command
-  cmd_ = p_term + i_term + d_term;
+  // Integrate the error, limited by the antiwindup, and compute the command.
+  // The integral term is clamped to i_min_/i_max_ without antiwindup, so that the limit is
+  // meaningful in the output
+  const pid_math::Step step = pid_math::computeStep(gains, i_error_, p_error_, d_error_, dt);
+  i_error_ = step.i_error;
+  cmd_ = step.command;
+  publishState();
 
+  CONTROL_TOOLBOX_TRACEPOINT2(pid_compute_command_exit, cmd_, i_error_);
   return cmd_;
 }
 
-void Pid::setCurrentCmd(double cmd) { cmd_ = cmd; }
+void Pid::setCurrentCmd(double cmd)
+{
+  cmd_ = cmd;
+  publishState();
+}
 
-double Pid::getDerivativeError() { return error_dot_; }
+double Pid::getDerivativeError() { return readState()[ERROR_DOT]; }
 
-double Pid::getCurrentCmd() { return cmd_; }
+double Pid::getCurrentCmd() { return readState()[CMD]; }
 
 void Pid::getCurrentPIDErrors(double & pe, double & ie, double & de)
 {
-  pe = p_error_;
-  ie = i_error_;
-  de = d_error_;
+  const std::array<double, STATE_SIZE> state = readState();
+  pe = state[P_ERROR];
+  ie = state[I_ERROR];
+  de = state[D_ERROR];
+}
+
+void Pid::publishState()
+{
+  const uint32_t sequence = state_sequence_.load(std::memory_order_relaxed);
+  state_sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  published_state_[P_ERROR].store(p_error_, std::memory_order_relaxed);
+  published_state_[I_ERROR].store(i_error_, std::memory_order_relaxed);
+  published_state_[D_ERROR].store(d_error_, std::memory_order_relaxed);
+  published_state_[CMD].store(cmd_, std::memory_order_relaxed);
+  published_state_[ERROR_DOT].store(error_dot_, std::memory_order_relaxed);
+  state_sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+std::array<double, Pid::STATE_SIZE> Pid::readState() const
+{
+  std::array<double, STATE_SIZE> state;
+  for (;;) {
+    const uint32_t before = state_sequence_.load(std::memory_order_acquire);
+    for (std::size_t k = 0; k < STATE_SIZE; ++k) {
+      state[k] = published_state_[k].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (before % 2 == 0 && state_sequence_.load(std::memory_order_relaxed) == before) {
+      return state;
+    }
+  }
 }
 }  // namespace control_toolbox
@@ -0,0 +1,272 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/pid_bank.hpp"
+#include "control_toolbox/pid_math.hpp"
+
+namespace control_toolbox
+{
+PidBank::PidBank()
+: max_slot_load_(0),
+  cycle_(0),
+  num_evaluations_(0),
+  num_skips_(0)
+{
+}
+
+bool PidBank::init(std::size_t num_channels, const Pid::Gains & gains)
+{
+  if (num_channels == 0) {
+    RCUTILS_LOG_ERROR("Pid bank needs at least one channel.");
+    return false;
+  }
+
+  p_error_.assign(num_channels, 0.0);
+  i_error_.assign(num_channels, 0.0);
+  d_error_.assign(num_channels, 0.0);
+  cmd_.assign(num_channels, 0.0);
+  elapsed_.assign(num_channels, 0);
+  held_.assign(num_channels, 0);
+  evaluated_.assign(num_channels, false);
+  active_.clear();
+  active_.reserve(num_channels);
+  {
+    std::lock_guard<std::mutex> lock(non_rt_mutex_);
+    gains_buffer_.writeFromNonRT(std::vector<Pid::Gains>(num_channels, gains));
+  }
+  schedule_buffer_.writeFromNonRT(Schedule());
+  max_slot_load_ = num_channels;
+  reset();
+  return true;
+}
+
+bool PidBank::setGains(const std::vector<Pid::Gains> & gains)
+{
+  if (gains.size() != size()) {
+    RCUTILS_LOG_ERROR("Pid bank needs one set of gains per channel.");
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(non_rt_mutex_);
+  gains_buffer_.writeFromNonRT(gains);
+  return true;
+}
+
+std::vector<Pid::Gains> PidBank::getGains()
+{
+  // The lock keeps the gains from being overwritten while they are copied
+  std::lock_guard<std::mutex> lock(non_rt_mutex_);
+  return *gains_buffer_.readFromNonRT();
+}
+
+bool PidBank::setEventTrigger(double error_threshold, uint64_t max_interval)
+{
+  if (!(error_threshold >= 0.0)) {
+    RCUTILS_LOG_ERROR("Pid bank error threshold must not be negative.");
+    return false;
+  }
+  EventTrigger trigger;
+  trigger.error_threshold = error_threshold;
+  trigger.max_interval = max_interval;
+  trigger_buffer_.writeFromNonRT(trigger);
+  return true;
+}
+
+bool PidBank::setRateDividers(const std::vector<unsigned int> & dividers)
+{
+  if (dividers.size() != size()) {
+    RCUTILS_LOG_ERROR("Pid bank needs one rate divider per channel.");
+    return false;
+  }
+
+  uint64_t hyperperiod = 1;
+  for (const unsigned int divider : dividers) {
+    if (divider == 0) {
+      RCUTILS_LOG_ERROR("Pid bank rate dividers must be at least 1.");
+      return false;
+    }
+    hyperperiod = std::lcm<uint64_t>(hyperperiod, divider);
+    if (hyperperiod > MAX_HYPERPERIOD) {
+      RCUTILS_LOG_ERROR("Pid bank rate dividers have too large a common multiple.");
+      return false;
+    }
+  }
+
+  // Greedy balancing: the fastest channels are placed first, each one in the phase whose most
+  // loaded cycle is the least loaded
+  std::vector<std::size_t> order(dividers.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&dividers](std::size_t a, std::size_t b) {
+    return dividers[a] < dividers[b];
+  });
+
+  Schedule schedule;
+  schedule.dividers = dividers;
+  schedule.phases.assign(dividers.size(), 0);
+  std::vector<std::size_t> load(hyperperiod, 0);
+  for (const std::size_t c : order) {
+    const unsigned int divider = dividers[c];
+    std::size_t best_load = std::numeric_limits<std::size_t>::max();
+    for (unsigned int phase = 0; phase < divider; ++phase) {
+      std::size_t phase_load = 0;
+      for (uint64_t cycle = phase; cycle < hyperperiod; cycle += divider) {
+        phase_load = std::max(phase_load, load[cycle]);
+      }
+      if (phase_load < best_load) {
+        best_load = phase_load;
+        schedule.phases[c] = phase;
+      }
+    }
+    for (uint64_t cycle = schedule.phases[c]; cycle < hyperperiod; cycle += divider) {
+      ++load[cycle];
+    }
+  }
+  schedule.max_slot_load = *std::max_element(load.begin(), load.end());
+
+  max_slot_load_ = schedule.max_slot_load;
+  schedule_buffer_.writeFromNonRT(schedule);
+  return true;
+}
+
+std::size_t PidBank::getMaxSlotLoad() const { return max_slot_load_; }
+
+void PidBank::reset()
+{
+  std::fill(p_error_.begin(), p_error_.end(), 0.0);
+  std::fill(i_error_.begin(), i_error_.end(), 0.0);
+  std::fill(d_error_.begin(), d_error_.end(), 0.0);
+  std::fill(cmd_.begin(), cmd_.end(), 0.0);
+  std::fill(elapsed_.begin(), elapsed_.end(), 0);
+  std::fill(held_.begin(), held_.end(), 0);
+  std::fill(evaluated_.begin(), evaluated_.end(), false);
+  active_.clear();
+  cycle_ = 0;
+  num_evaluations_ = 0;
+  num_skips_ = 0;
+}
+
+bool PidBank::computeCommands(
+  const std::vector<double> & errors, uint64_t dt, std::vector<double> & commands)
+{
+  const std::size_t n = size();
+  if (dt == 0 || errors.size() != n) {
+    return false;
+  }
+  commands.resize(n);
+
+  // First pass: gather the due and triggered channels
+  const Schedule & schedule = *schedule_buffer_.readFromRT();
+  const EventTrigger & trigger = *trigger_buffer_.readFromRT();
+  const bool multi_rate = schedule.dividers.size() == n;
+  std::size_t num_due = 0;
+  active_.clear();
+  for (std::size_t c = 0; c < n; ++c) {
+    const double error = errors[c];
+    if (!std::isfinite(error)) {
+      commands[c] = 0.0;
+      continue;
+    }
+    elapsed_[c] += dt;
+    if (multi_rate && cycle_ % schedule.dividers[c] != schedule.phases[c]) {
+      commands[c] = cmd_[c];
+      continue;
+    }
+    ++num_due;
+    if (
+      !evaluated_[c] || elapsed_[c] >= trigger.max_interval ||
+      std::abs(error - p_error_[c]) > trigger.error_threshold) {
+      active_.push_back(c);
+    } else {
+      // Up to now the error stayed within the threshold of its last evaluated value
+      held_[c] = elapsed_[c];
+      commands[c] = cmd_[c];
+    }
+  }
+  ++cycle_;
+  num_evaluations_ += active_.size();
+  num_skips_ += num_due - active_.size();
+
+  // Second pass: compute the triggered channels
+  const std::vector<Pid::Gains> & gains = *gains_buffer_.readFromRT();
+  for (const std::size_t c : active_) {
+    const Pid::Gains & g = gains[c];
+    const double error = errors[c];
+    const double interval = elapsed_[c] / 1e9;
+
+    // The cycles skipped by the event trigger had the last evaluated error, the rest of the
+    // interval is integrated with the current error as a Pid at the rate of the channel would
+    const double held = held_[c] / 1e9;
+    d_error_[c] = pid_math::differentiate(error, p_error_[c], elapsed_[c]);
+    i_error_[c] = pid_math::limitIntegralError(
+      g, i_error_[c] + held * p_error_[c] + (interval - held) * error);
+
+    p_error_[c] = error;
+    cmd_[c] = pid_math::command(g, error, pid_math::integralTerm(g, i_error_[c]), d_error_[c]);
+    commands[c] = cmd_[c];
+    elapsed_[c] = 0;
+    held_[c] = 0;
+    evaluated_[c] = true;
+  }
+  return true;
+}
+
+const std::vector<std::size_t> & PidBank::getActiveChannels() const { return active_; }
+
+void PidBank::getCurrentPIDErrors(
+  std::size_t channel, double & pe, double & ie, double & de) const
+{
+  if (channel >= size()) {
+    pe = ie = de = 0.0;
+    return;
+  }
+  pe = p_error_[channel];
+  ie = i_error_[channel];
+  de = d_error_[channel];
+}
+
+double PidBank::getSkipRatio() const
+{
+  const uint64_t total = num_evaluations_ + num_skips_;
+  return total > 0 ? static_cast<double>(num_skips_) / total : 0.0;
+}
+
+std::size_t PidBank::size() const { return cmd_.size(); }
+
+}  // namespace control_toolbox
@@ -39,6 +39,7 @@
 #include <vector>
 
 #include "control_toolbox/pid_ros.hpp"
+#include "control_toolbox/tracing.hpp"
 
 namespace control_toolbox
 {
@@ -73,6 +74,10 @@ void PidROS::initialize(std::string topic_prefix)
     topics_interface_, topic_prefix_ + "pid_state", rclcpp::SensorDataQoS());
   rt_state_pub_.reset(
     new realtime_tools::RealtimePublisher<control_msgs::msg::PidState>(state_pub_));
+
+  // Built once, the realtime loop only reads the time from it
+  system_clock_ = std::make_shared<rclcpp::Clock>();
+  clock_buffer_.writeFromNonRT(system_clock_);
 }
 
 bool PidROS::getBooleanParam(const std::string & param_name, bool & value)
@@ -203,30 +208,88 @@ void PidROS::setGains(double p, double i, double d, double i_max, double i_min,
 
 void PidROS::publishPIDState(double cmd, double error, rclcpp::Duration dt)
 {
-  Pid::Gains gains = pid_.getGains();
+  CONTROL_TOOLBOX_TRACEPOINT3(pid_ros_publish_state_entry, cmd, error, dt.nanoseconds());
+
+  // The gains actually applied, after the schedule, the ramp and the gain curve
+  Pid::Gains gains = pid_.getActiveGains();
 
   double p_error_, i_error_, d_error_;
   getCurrentPIDErrors(p_error_, i_error_, d_error_);
 
-  // Publish controller state if configured
-  if (rt_state_pub_) {
+  // The state messages and the telemetry records share the stamp
+  const rclcpp::Time now = (*clock_buffer_.readFromRT())->now();
+
+  auto fill_state = [&](control_msgs::msg::PidState & msg) {
+    msg.header.stamp = now;
+    msg.timestep = dt;
+    msg.error = error;
+    msg.error_dot = pid_.getDerivativeError();
+    msg.p_error = p_error_;
+    msg.i_error = i_error_;
+    msg.d_error = d_error_;
+    msg.p_term = gains.p_gain_;
+    msg.i_term = gains.i_gain_;
+    msg.d_term = gains.d_gain_;
+    msg.i_max = gains.i_max_;
+    msg.i_min = gains.i_min_;
+    msg.output = cmd;
+  };
+
+  // Publish controller state if configured, or hand it to the state callback
+  bool published = false;
+  const StateCallback & state_callback = *state_callback_buffer_.readFromRT();
+  if (state_callback) {
+    fill_state(state_msg_);
+    state_callback(state_msg_);
+    published = true;
+  } else if (rt_state_pub_) {
     if (rt_state_pub_->trylock()) {
-      rt_state_pub_->msg_.header.stamp = rclcpp::Clock().now();
-      rt_state_pub_->msg_.timestep = dt;
-      rt_state_pub_->msg_.error = error;
-      rt_state_pub_->msg_.error_dot = pid_.getDerivativeError();
-      rt_state_pub_->msg_.p_error = p_error_;
-      rt_state_pub_->msg_.i_error = i_error_;
-      rt_state_pub_->msg_.d_error = d_error_;
-      rt_state_pub_->msg_.p_term = gains.p_gain_;
-      rt_state_pub_->msg_.i_term = gains.i_gain_;
-      rt_state_pub_->msg_.d_term = gains.d_gain_;
-      rt_state_pub_->msg_.i_max = gains.i_max_;
-      rt_state_pub_->msg_.i_min = gains.i_min_;
-      rt_state_pub_->msg_.output = cmd;
+      published = true;
+      fill_state(rt_state_pub_->msg_);
       rt_state_pub_->unlockAndPublish();
     }
   }
+
+  TelemetryWriter * telemetry = telemetry_buffer_.readFromRT()->get();
+  if (telemetry) {
+    // Same order as the channels given in enableTelemetry
+    const double values[] = {error,         pid_.getDerivativeError(),
+                             p_error_,      i_error_,
+                             d_error_,      gains.p_gain_,
+                             gains.i_gain_, gains.d_gain_,
+                             gains.i_max_,  gains.i_min_,
+                             cmd,           dt.seconds()};
+    telemetry->write(now.nanoseconds(), values);
+  }
+
+  CONTROL_TOOLBOX_TRACEPOINT1(pid_ros_publish_state_exit, published);
+}
+
+bool PidROS::enableTelemetry(const std::string & name, std::size_t capacity)
+{
+  auto telemetry = std::make_shared<TelemetryWriter>();
+  if (!telemetry->init(
+        name,
+        {"error", "error_dot", "p_error", "i_error", "d_error", "p_gain", "i_gain", "d_gain",
+         "i_max", "i_min", "output", "timestep"},
+        capacity))
+  {
+    return false;
+  }
+  telemetry_buffer_.writeFromNonRT(telemetry);
+  return true;
+}
+
+void PidROS::disableTelemetry() { telemetry_buffer_.writeFromNonRT(nullptr); }
+
+void PidROS::setClock(rclcpp::Clock::SharedPtr clock)
+{
+  clock_buffer_.writeFromNonRT(clock ? clock : system_clock_);
+}
+
+void PidROS::setStateCallback(StateCallback callback)
+{
+  state_callback_buffer_.writeFromNonRT(callback);
 }
 
 void PidROS::setCurrentCmd(double cmd) { pid_.setCurrentCmd(cmd); }
@@ -244,7 +307,7 @@ void PidROS::getCurrentPIDErrors(double & pe, double & ie, double & de)
 
 void PidROS::printValues()
 {
-  Pid::Gains gains = pid_.getGains();
+  Pid::Gains gains = pid_.getGainsNonRT();
 
   double p_error_, i_error_, d_error_;
   getCurrentPIDErrors(p_error_, i_error_, d_error_);
@@ -268,11 +331,13 @@ void PidROS::setGains(const Pid::Gains & gains) { pid_.setGains(gains); }
 void PidROS::setParameterEventCallback()
 {
   auto on_parameter_event_callback = [this](const std::vector<rclcpp::Parameter> & parameters) {
+    CONTROL_TOOLBOX_TRACEPOINT1(pid_ros_parameter_callback_entry, parameters.size());
+
     rcl_interfaces::msg::SetParametersResult result;
     result.successful = true;
 
     /// @note don't use getGains, it's rt
-    Pid::Gains gains = pid_.getGains();
+    Pid::Gains gains = pid_.getGainsNonRT();
     bool changed = false;
 
     for (auto & parameter : parameters) {
@@ -307,6 +372,7 @@ void PidROS::setParameterEventCallback()
       pid_.setGains(gains);
     }
 
+    CONTROL_TOOLBOX_TRACEPOINT1(pid_ros_parameter_callback_exit, changed);
     return result;
   };
   /// @note this gets called whenever a parameter changes.
@@ -0,0 +1,172 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/reference_prefilter.hpp"
+
+namespace control_toolbox
+{
+BiquadCoefficients discretizeBiquad(
+  const std::array<double, 3> & numerator, const std::array<double, 3> & denominator,
+  double sample_rate, double prewarp_frequency)
+{
+  // s = k (1 - z^-1) / (1 + z^-1)
+  double k = 2.0 * sample_rate;
+  if (prewarp_frequency > 0.0) {
+    const double w = 2.0 * M_PI * prewarp_frequency;
+    k = w / std::tan(w / (2.0 * sample_rate));
+  }
+  const double k2 = k * k;
+
+  const auto expand = [k, k2](const std::array<double, 3> & p) {
+    return std::array<double, 3>{
+      p[2] * k2 + p[1] * k + p[0], 2.0 * (p[0] - p[2] * k2), p[2] * k2 - p[1] * k + p[0]};
+  };
+  const std::array<double, 3> b = expand(numerator);
+  const std::array<double, 3> a = expand(denominator);
+
+  BiquadCoefficients coefficients;
+  coefficients.b0 = b[0] / a[0];
+  coefficients.b1 = b[1] / a[0];
+  coefficients.b2 = b[2] / a[0];
+  coefficients.a1 = a[1] / a[0];
+  coefficients.a2 = a[2] / a[0];
+  return coefficients;
+}
+
+ReferencePrefilter::ReferencePrefilter() {}
+
+bool ReferencePrefilter::initCriticallyDamped(
+  std::size_t num_channels, double bandwidth, double sample_rate)
+{
+  if (!(sample_rate > 0.0) || !(bandwidth > 0.0) || bandwidth >= sample_rate / 2.0) {
+    RCUTILS_LOG_ERROR("Prefilter bandwidth must be positive and below the Nyquist frequency.");
+    return false;
+  }
+
+  const double w = 2.0 * M_PI * bandwidth;
+  const BiquadCoefficients coefficients =
+    discretizeBiquad({w * w, 0.0, 0.0}, {w * w, 2.0 * w, 1.0}, sample_rate, bandwidth);
+  return setCoefficients(num_channels, coefficients);
+}
+
+bool ReferencePrefilter::initModelMatching(
+  std::size_t num_channels, const std::array<double, 3> & numerator,
+  const std::array<double, 3> & denominator, double sample_rate)
+{
+  if (!(sample_rate > 0.0)) {
+    RCUTILS_LOG_ERROR("Prefilter sample rate must be positive.");
+    return false;
+  }
+  // The bilinear transform of the denominator has a zero leading coefficient otherwise
+  const double k = 2.0 * sample_rate;
+  if (denominator[2] * k * k + denominator[1] * k + denominator[0] == 0.0) {
+    RCUTILS_LOG_ERROR("Prefilter model denominator cannot be discretized.");
+    return false;
+  }
+
+  return setCoefficients(num_channels, discretizeBiquad(numerator, denominator, sample_rate));
+}
+
+bool ReferencePrefilter::setCoefficients(
+  std::size_t num_channels, const BiquadCoefficients & coefficients)
+{
+  if (num_channels == 0) {
+    RCUTILS_LOG_ERROR("Prefilter needs at least one channel.");
+    return false;
+  }
+
+  // Both poles must lie inside the unit circle
+  if (std::abs(coefficients.a2) >= 1.0 || std::abs(coefficients.a1) >= 1.0 + coefficients.a2) {
+    RCUTILS_LOG_ERROR("Prefilter model is not stable.");
+    return false;
+  }
+
+  coefficients_ = coefficients;
+  state1_.assign(num_channels, 0.0);
+  state2_.assign(num_channels, 0.0);
+  return true;
+}
+
+void ReferencePrefilter::reset(const std::vector<double> & references)
+{
+  const BiquadCoefficients & c = coefficients_;
+  const double gain = (c.b0 + c.b1 + c.b2) / (1.0 + c.a1 + c.a2);
+  for (std::size_t i = 0; i < state1_.size() && i < references.size(); ++i) {
+    const double x = references[i];
+    const double y = gain * x;
+    state1_[i] = y - c.b0 * x;
+    state2_[i] = c.b2 * x - c.a2 * y;
+  }
+}
+
+bool ReferencePrefilter::update(
+  const std::vector<double> & references, std::vector<double> & filtered)
+{
+  const std::size_t n = state1_.size();
+  if (references.size() != n) {
+    return false;
+  }
+  const BiquadCoefficients c = coefficients_;
+  filtered.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const double x = references[i];
+    const double y = c.b0 * x + state1_[i];
+    state1_[i] = c.b1 * x - c.a1 * y + state2_[i];
+    state2_[i] = c.b2 * x - c.a2 * y;
+    filtered[i] = y;
+  }
+  return true;
+}
+
+double ReferencePrefilter::update(std::size_t channel, double reference)
+{
+  if (channel >= state1_.size()) {
+    return reference;
+  }
+  const BiquadCoefficients & c = coefficients_;
+  const double y = c.b0 * reference + state1_[channel];
+  state1_[channel] = c.b1 * reference - c.a1 * y + state2_[channel];
+  state2_[channel] = c.b2 * reference - c.a2 * y;
+  return y;
+}
+
+const BiquadCoefficients & ReferencePrefilter::getCoefficients() const { return coefficients_; }
+
+std::size_t ReferencePrefilter::size() const { return state1_.size(); }
+
+}  // namespace control_toolbox
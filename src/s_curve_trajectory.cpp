@@ -0,0 +1,217 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/s_curve_trajectory.hpp"
+
+namespace control_toolbox
+{
+SCurveTrajectory::SCurveTrajectory()
+{
+  durations_.fill(0.0);
+  jerks_.fill(0.0);
+  positions_.fill(0.0);
+  computeBoundaries();
+}
+
+bool SCurveTrajectory::init(
+  double start, double goal, double max_velocity, double max_acceleration, double max_jerk)
+{
+  if (
+    max_velocity <= 0.0 || max_acceleration <= 0.0 || max_jerk <= 0.0 || !std::isfinite(start) ||
+    !std::isfinite(goal)) {
+    RCUTILS_LOG_ERROR("S-curve limits must be strictly positive and the positions finite.");
+    return false;
+  }
+
+  const double distance = std::abs(goal - start);
+  const double direction = goal >= start ? 1.0 : -1.0;
+  const double j = max_jerk;
+
+  // Peak velocity and acceleration of the profile
+  double v = max_velocity;
+  double a = std::min(max_acceleration, std::sqrt(max_velocity * j));
+  if (v * (v / a + a / j) > distance) {
+    // No cruise phase: lower the peak velocity, first keeping the acceleration limit
+    a = max_acceleration;
+    v = 0.5 * a * (-a / j + std::sqrt(a * a / (j * j) + 4.0 * distance / a));
+    if (v * j < a * a) {
+      // The acceleration limit is not reached either
+      v = std::cbrt(distance * distance * j / 4.0);
+      a = std::sqrt(v * j);
+    }
+  }
+
+  double jerk_time = 0.0, acceleration_time = 0.0, cruise_time = 0.0;
+  if (distance > 0.0) {
+    jerk_time = a / j;
+    acceleration_time = std::max(0.0, v / a - jerk_time);
+    cruise_time = std::max(0.0, (distance - v * (v / a + a / j)) / v);
+  }
+
+  durations_ = {jerk_time, acceleration_time, jerk_time, cruise_time,
+                jerk_time, acceleration_time, jerk_time};
+  jerks_ = {j, 0.0, -j, 0.0, -j, 0.0, j};
+  for (auto & jerk : jerks_) {
+    jerk *= direction;
+  }
+  positions_[0] = start;
+  computeBoundaries();
+
+  // Remove the accumulated rounding error on the goal
+  positions_[NUM_SEGMENTS] = goal;
+
+  return true;
+}
+
+void SCurveTrajectory::computeBoundaries()
+{
+  times_[0] = 0.0;
+  velocities_[0] = 0.0;
+  accelerations_[0] = 0.0;
+  for (std::size_t s = 0; s < NUM_SEGMENTS; ++s) {
+    const double t = durations_[s];
+    const double jerk = jerks_[s];
+    const double a = accelerations_[s];
+    const double v = velocities_[s];
+    times_[s + 1] = times_[s] + t;
+    positions_[s + 1] = positions_[s] + t * (v + t * (a / 2.0 + t * jerk / 6.0));
+    velocities_[s + 1] = v + t * (a + t * jerk / 2.0);
+    accelerations_[s + 1] = a + t * jerk;
+  }
+}
+
+bool SCurveTrajectory::scaleToDuration(double duration)
+{
+  const double current = getDuration();
+  if (duration < current || !std::isfinite(duration)) {
+    RCUTILS_LOG_ERROR("S-curve trajectories can only be slowed down.");
+    return false;
+  }
+  if (current <= 0.0 || duration == current) {
+    return true;
+  }
+
+  // Stretching time by k divides velocities by k, accelerations by k^2 and jerks by k^3
+  const double k = duration / current;
+  const double goal = positions_[NUM_SEGMENTS];
+  for (std::size_t s = 0; s < NUM_SEGMENTS; ++s) {
+    durations_[s] *= k;
+    jerks_[s] /= k * k * k;
+  }
+  computeBoundaries();
+  positions_[NUM_SEGMENTS] = goal;
+
+  return true;
+}
+
+double SCurveTrajectory::getDuration() const { return times_[NUM_SEGMENTS]; }
+
+double SCurveTrajectory::update(double time, double & qd, double & qdd) const
+{
+  if (!(time > 0.0)) {
+    qd = velocities_[0];
+    qdd = accelerations_[0];
+    return positions_[0];
+  }
+  if (time >= times_[NUM_SEGMENTS]) {
+    qd = 0.0;
+    qdd = 0.0;
+    return positions_[NUM_SEGMENTS];
+  }
+
+  std::size_t s = 0;
+  while (s + 1 < NUM_SEGMENTS && time >= times_[s + 1]) {
+    ++s;
+  }
+
+  const double t = time - times_[s];
+  const double jerk = jerks_[s];
+  const double a = accelerations_[s];
+  const double v = velocities_[s];
+  qdd = a + t * jerk;
+  qd = v + t * (a + t * jerk / 2.0);
+  return positions_[s] + t * (v + t * (a / 2.0 + t * jerk / 6.0));
+}
+
+bool SynchronizedSCurveTrajectory::init(
+  const std::vector<double> & start, const std::vector<double> & goal,
+  const std::vector<double> & max_velocity, const std::vector<double> & max_acceleration,
+  const std::vector<double> & max_jerk)
+{
+  const std::size_t n = start.size();
+  if (
+    goal.size() != n || max_velocity.size() != n || max_acceleration.size() != n ||
+    max_jerk.size() != n) {
+    RCUTILS_LOG_ERROR("S-curve axes must all have the same number of limits and positions.");
+    return false;
+  }
+
+  std::vector<SCurveTrajectory> axes(n);
+  double duration = 0.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!axes[i].init(start[i], goal[i], max_velocity[i], max_acceleration[i], max_jerk[i])) {
+      return false;
+    }
+    duration = std::max(duration, axes[i].getDuration());
+  }
+  for (auto & axis : axes) {
+    axis.scaleToDuration(duration);
+  }
+
+  axes_ = std::move(axes);
+  duration_ = duration;
+  return true;
+}
+
+double SynchronizedSCurveTrajectory::getDuration() const { return duration_; }
+
+std::size_t SynchronizedSCurveTrajectory::size() const { return axes_.size(); }
+
+void SynchronizedSCurveTrajectory::update(
+  double time, std::vector<double> & q, std::vector<double> & qd, std::vector<double> & qdd) const
+{
+  q.resize(axes_.size());
+  qd.resize(axes_.size());
+  qdd.resize(axes_.size());
+  for (std::size_t i = 0; i < axes_.size(); ++i) {
+    q[i] = axes_[i].update(time, qd[i], qdd[i]);
+  }
+}
+
+}  // namespace control_toolbox
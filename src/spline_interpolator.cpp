@@ -0,0 +1,219 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/spline_interpolator.hpp"
+
+namespace control_toolbox
+{
+SplineInterpolator::SplineInterpolator()
+: num_axes_(0), order_(Order::CUBIC), buffer_size_(0), head_(0), num_knots_(0)
+{
+}
+
+bool SplineInterpolator::init(std::size_t num_axes, Order order, std::size_t buffer_size)
+{
+  if (num_axes == 0 || buffer_size < 3) {
+    RCUTILS_LOG_ERROR("Spline interpolator needs at least one axis and three buffered knots.");
+    return false;
+  }
+
+  num_axes_ = num_axes;
+  order_ = order;
+  buffer_size_ = buffer_size;
+  times_.assign(buffer_size, 0.0);
+  positions_.assign(buffer_size * num_axes, 0.0);
+  velocities_.assign(buffer_size * num_axes, 0.0);
+  accelerations_.assign(buffer_size * num_axes, 0.0);
+  coefficients_.assign(buffer_size * NUM_COEFFICIENTS * num_axes, 0.0);
+  reset();
+  return true;
+}
+
+void SplineInterpolator::reset()
+{
+  head_ = 0;
+  num_knots_ = 0;
+}
+
+std::size_t SplineInterpolator::getNumKnots() const { return num_knots_; }
+
+std::size_t SplineInterpolator::slot(std::size_t knot) const
+{
+  return (head_ + knot) % buffer_size_;
+}
+
+bool SplineInterpolator::addKnot(double time, const std::vector<double> & positions)
+{
+  if (
+    num_knots_ == buffer_size_ || positions.size() != num_axes_ || !std::isfinite(time) ||
+    (num_knots_ > 0 && !(time > times_[slot(num_knots_ - 1)]))) {
+    return false;
+  }
+
+  const std::size_t s = slot(num_knots_);
+  times_[s] = time;
+  for (std::size_t i = 0; i < num_axes_; ++i) {
+    positions_[s * num_axes_ + i] = positions[i];
+  }
+  ++num_knots_;
+
+  // The new knot completes the derivatives of the previous one, and with them the segment
+  // ending there
+  if (num_knots_ >= 2) {
+    computeDerivatives(num_knots_ - 2);
+  }
+  if (num_knots_ >= 3) {
+    computeCoefficients(num_knots_ - 3);
+  }
+  return true;
+}
+
+void SplineInterpolator::computeDerivatives(std::size_t knot)
+{
+  const std::size_t s = slot(knot);
+  const std::size_t next = slot(knot + 1);
+  const double h1 = times_[next] - times_[s];
+
+  if (knot == 0) {
+    // One sided difference at the start of the stream
+    for (std::size_t i = 0; i < num_axes_; ++i) {
+      velocities_[s * num_axes_ + i] =
+        (positions_[next * num_axes_ + i] - positions_[s * num_axes_ + i]) / h1;
+      accelerations_[s * num_axes_ + i] = 0.0;
+    }
+    return;
+  }
+
+  // Second order accurate differences on a non uniform grid
+  const std::size_t previous = slot(knot - 1);
+  const double h0 = times_[s] - times_[previous];
+  const double h = h0 + h1;
+  for (std::size_t i = 0; i < num_axes_; ++i) {
+    const double slope0 =
+      (positions_[s * num_axes_ + i] - positions_[previous * num_axes_ + i]) / h0;
+    const double slope1 = (positions_[next * num_axes_ + i] - positions_[s * num_axes_ + i]) / h1;
+    velocities_[s * num_axes_ + i] = (slope0 * h1 + slope1 * h0) / h;
+    accelerations_[s * num_axes_ + i] = 2.0 * (slope1 - slope0) / h;
+  }
+}
+
+void SplineInterpolator::computeCoefficients(std::size_t knot)
+{
+  const std::size_t s = slot(knot);
+  const std::size_t next = slot(knot + 1);
+  const double h = times_[next] - times_[s];
+  double * c = &coefficients_[s * NUM_COEFFICIENTS * num_axes_];
+
+  for (std::size_t i = 0; i < num_axes_; ++i) {
+    const double p0 = positions_[s * num_axes_ + i];
+    const double v0 = velocities_[s * num_axes_ + i];
+    const double a0 = accelerations_[s * num_axes_ + i];
+    const double v1 = velocities_[next * num_axes_ + i];
+    const double a1 = accelerations_[next * num_axes_ + i];
+    const double dp = positions_[next * num_axes_ + i] - p0;
+
+    c[i] = p0;
+    c[num_axes_ + i] = v0;
+    if (order_ == Order::CUBIC) {
+      c[2 * num_axes_ + i] = (3.0 * dp / h - 2.0 * v0 - v1) / h;
+      c[3 * num_axes_ + i] = (-2.0 * dp / h + v0 + v1) / (h * h);
+      c[4 * num_axes_ + i] = 0.0;
+      c[5 * num_axes_ + i] = 0.0;
+    } else {
+      const double h2 = h * h;
+      c[2 * num_axes_ + i] = 0.5 * a0;
+      c[3 * num_axes_ + i] =
+        (20.0 * dp - (8.0 * v1 + 12.0 * v0) * h - (3.0 * a0 - a1) * h2) / (2.0 * h2 * h);
+      c[4 * num_axes_ + i] =
+        (-30.0 * dp + (14.0 * v1 + 16.0 * v0) * h + (3.0 * a0 - 2.0 * a1) * h2) / (2.0 * h2 * h2);
+      c[5 * num_axes_ + i] =
+        (12.0 * dp - 6.0 * (v1 + v0) * h - (a0 - a1) * h2) / (2.0 * h2 * h2 * h);
+    }
+  }
+}
+
+void SplineInterpolator::hold(
+  std::size_t knot, std::vector<double> & q, std::vector<double> & qd,
+  std::vector<double> & qdd) const
+{
+  const std::size_t s = slot(knot);
+  for (std::size_t i = 0; i < num_axes_; ++i) {
+    q[i] = positions_[s * num_axes_ + i];
+    qd[i] = 0.0;
+    qdd[i] = 0.0;
+  }
+}
+
+bool SplineInterpolator::update(
+  double time, std::vector<double> & q, std::vector<double> & qd, std::vector<double> & qdd)
+{
+  q.resize(num_axes_);
+  qd.resize(num_axes_);
+  qdd.resize(num_axes_);
+  if (num_knots_ == 0) {
+    return false;
+  }
+
+  // Drop the knots already passed. At least two are kept, as the derivatives at the newest knot
+  // need the one before it.
+  while (num_knots_ >= 3 && time >= times_[slot(1)]) {
+    head_ = slot(1);
+    --num_knots_;
+  }
+
+  // A segment can be evaluated once the derivatives at its end are known
+  if (num_knots_ < 3 || time < times_[head_]) {
+    hold(num_knots_ > 1 && time >= times_[slot(1)] ? 1 : 0, q, qd, qdd);
+    return false;
+  }
+
+  const double t = time - times_[head_];
+  const double * c0 = &coefficients_[head_ * NUM_COEFFICIENTS * num_axes_];
+  const double * c1 = c0 + num_axes_;
+  const double * c2 = c1 + num_axes_;
+  const double * c3 = c2 + num_axes_;
+  const double * c4 = c3 + num_axes_;
+  const double * c5 = c4 + num_axes_;
+  for (std::size_t i = 0; i < num_axes_; ++i) {
+    q[i] = ((((c5[i] * t + c4[i]) * t + c3[i]) * t + c2[i]) * t + c1[i]) * t + c0[i];
+    qd[i] = (((5.0 * c5[i] * t + 4.0 * c4[i]) * t + 3.0 * c3[i]) * t + 2.0 * c2[i]) * t + c1[i];
+    qdd[i] = ((20.0 * c5[i] * t + 12.0 * c4[i]) * t + 6.0 * c3[i]) * t + 2.0 * c2[i];
+  }
+  return true;
+}
+
+}  // namespace control_toolbox
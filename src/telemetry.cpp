@@ -0,0 +1,333 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CONTROL_TOOLBOX_HAS_SHM
+#endif
+
+#include "rcutils/logging_macros.h"
+
+#include "control_toolbox/telemetry.hpp"
+
+namespace control_toolbox
+{
+namespace
+{
+constexpr uint32_t TELEMETRY_MAGIC = 0x43544c4d;  // "CTLM"
+constexpr uint32_t TELEMETRY_VERSION = 1;
+
+// A record is a sequence number, a time stamp and the values. The sequence
+// number is the index of the record plus one once it is complete, 0 while
+// the writer is filling it.
+constexpr std::size_t RECORD_HEADER_SIZE = 2 * sizeof(uint64_t);
+
+std::string shmName(const std::string & name)
+{
+  return (!name.empty() && name.front() == '/') ? name : "/" + name;
+}
+}  // namespace
+
+/*!
+ * \brief Start of the shared memory object, followed by the records
+ */
+struct TelemetryHeader
+{
+  std::atomic<uint32_t> magic;       /**< Written last, once the object is ready. */
+  uint32_t version;                  /**< Layout version. */
+  uint32_t num_channels;             /**< Number of values per record. */
+  uint32_t record_size;              /**< Size of a record in bytes. */
+  uint64_t capacity;                 /**< Number of records in the ring. */
+  std::atomic<uint64_t> write_index; /**< Number of records written so far. */
+  /** Channel names, null terminated. */
+  char channels[TelemetryWriter::MAX_CHANNELS][TelemetryWriter::MAX_NAME_LENGTH + 1];
+};
+
+TelemetryWriter::TelemetryWriter()
+: device_(0),
+  inode_(0),
+  memory_(nullptr),
+  size_(0),
+  header_(nullptr),
+  records_(nullptr),
+  next_index_(0)
+{
+}
+
+TelemetryWriter::~TelemetryWriter() { close(); }
+
+bool TelemetryWriter::init(
+  const std::string & name, const std::vector<std::string> & channels, std::size_t capacity)
+{
+  close();
+
+  if (channels.empty() || channels.size() > MAX_CHANNELS || capacity == 0) {
+    RCUTILS_LOG_ERROR("Telemetry needs between 1 and %zu channels and a capacity.", MAX_CHANNELS);
+    return false;
+  }
+  for (const auto & channel : channels) {
+    if (channel.empty() || channel.size() > MAX_NAME_LENGTH) {
+      RCUTILS_LOG_ERROR("Telemetry channel names must have 1 to %zu characters.", MAX_NAME_LENGTH);
+      return false;
+    }
+  }
+
+#ifdef CONTROL_TOOLBOX_HAS_SHM
+  const std::string shm_name = shmName(name);
+  const std::size_t record_size = RECORD_HEADER_SIZE + channels.size() * sizeof(double);
+  const std::size_t size = sizeof(TelemetryHeader) + capacity * record_size;
+
+  // A writer of a previous ring may still be mapping it: unlinking the name and creating a new
+  // object, rather than truncating the existing one, leaves its mapping intact
+  shm_unlink(shm_name.c_str());
+  const int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    RCUTILS_LOG_ERROR("Could not create telemetry object %s.", shm_name.c_str());
+    return false;
+  }
+  void * memory = MAP_FAILED;
+  struct stat status;
+  if (fstat(fd, &status) == 0 && ftruncate(fd, static_cast<off_t>(size)) == 0) {
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    RCUTILS_LOG_ERROR("Could not map telemetry object %s.", shm_name.c_str());
+    shm_unlink(shm_name.c_str());
+    return false;
+  }
+
+  // Touch every page now, so the realtime writer never faults on them
+  std::memset(memory, 0, size);
+
+  header_ = new (memory) TelemetryHeader();
+  header_->version = TELEMETRY_VERSION;
+  header_->num_channels = static_cast<uint32_t>(channels.size());
+  header_->record_size = static_cast<uint32_t>(record_size);
+  header_->capacity = capacity;
+  header_->write_index.store(0, std::memory_order_relaxed);
+  for (std::size_t k = 0; k < channels.size(); ++k) {
+    std::strncpy(header_->channels[k], channels[k].c_str(), MAX_NAME_LENGTH);
+  }
+  header_->magic.store(TELEMETRY_MAGIC, std::memory_order_release);
+
+  name_ = shm_name;
+  device_ = static_cast<uint64_t>(status.st_dev);
+  inode_ = static_cast<uint64_t>(status.st_ino);
+  memory_ = memory;
+  size_ = size;
+  records_ = static_cast<unsigned char *>(memory) + sizeof(TelemetryHeader);
+  next_index_ = 0;
+  return true;
+#else
+  (void)name;
+  RCUTILS_LOG_ERROR("Telemetry needs POSIX shared memory, not available on this platform.");
+  return false;
+#endif
+}
+
+void TelemetryWriter::close()
+{
+#ifdef CONTROL_TOOLBOX_HAS_SHM
+  if (memory_ != nullptr) {
+    munmap(memory_, size_);
+    // Only remove the name if it was not taken over by a newer ring since
+    const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+      struct stat status;
+      const bool owned = fstat(fd, &status) == 0 &&
+                         static_cast<uint64_t>(status.st_dev) == device_ &&
+                         static_cast<uint64_t>(status.st_ino) == inode_;
+      ::close(fd);
+      if (owned) {
+        shm_unlink(name_.c_str());
+      }
+    }
+  }
+#endif
+  memory_ = nullptr;
+  size_ = 0;
+  header_ = nullptr;
+  records_ = nullptr;
+}
+
+void TelemetryWriter::write(int64_t stamp, const double * values)
+{
+  if (header_ == nullptr) {
+    return;
+  }
+
+  unsigned char * record = records_ + (next_index_ % header_->capacity) * header_->record_size;
+  auto sequence = reinterpret_cast<std::atomic<uint64_t> *>(record);
+
+  // Invalidate the record before overwriting it, readers check it again after copying
+  sequence->store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(record + sizeof(uint64_t), &stamp, sizeof(stamp));
+  std::memcpy(record + RECORD_HEADER_SIZE, values, header_->num_channels * sizeof(double));
+
+  ++next_index_;
+  sequence->store(next_index_, std::memory_order_release);
+  header_->write_index.store(next_index_, std::memory_order_release);
+}
+
+std::size_t TelemetryWriter::getNumChannels() const
+{
+  return header_ == nullptr ? 0 : header_->num_channels;
+}
+
+TelemetryReader::TelemetryReader()
+: memory_(nullptr), size_(0), header_(nullptr), records_(nullptr), cursor_(0), num_dropped_(0)
+{
+}
+
+TelemetryReader::~TelemetryReader() { detach(); }
+
+bool TelemetryReader::attach(const std::string & name)
+{
+  detach();
+
+#ifdef CONTROL_TOOLBOX_HAS_SHM
+  const std::string shm_name = shmName(name);
+  const int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    RCUTILS_LOG_ERROR("Telemetry object %s does not exist.", shm_name.c_str());
+    return false;
+  }
+  struct stat info;
+  void * memory = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(TelemetryHeader)) {
+    memory = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    RCUTILS_LOG_ERROR("Could not map telemetry object %s.", shm_name.c_str());
+    return false;
+  }
+  memory_ = memory;
+  size_ = static_cast<std::size_t>(info.st_size);
+  header_ = static_cast<const TelemetryHeader *>(memory);
+
+  if (
+    header_->magic.load(std::memory_order_acquire) != TELEMETRY_MAGIC ||
+    header_->version != TELEMETRY_VERSION || header_->num_channels == 0 ||
+    header_->num_channels > TelemetryWriter::MAX_CHANNELS || header_->capacity == 0 ||
+    header_->record_size != RECORD_HEADER_SIZE + header_->num_channels * sizeof(double) ||
+    size_ < sizeof(TelemetryHeader) + header_->capacity * header_->record_size)
+  {
+    RCUTILS_LOG_ERROR(
+      "Telemetry object %s is not ready or has an unknown layout.", shm_name.c_str());
+    detach();
+    return false;
+  }
+
+  records_ = static_cast<const unsigned char *>(memory) + sizeof(TelemetryHeader);
+  for (uint32_t k = 0; k < header_->num_channels; ++k) {
+    channels_.emplace_back(
+      header_->channels[k], strnlen(header_->channels[k], TelemetryWriter::MAX_NAME_LENGTH));
+  }
+  const uint64_t written = header_->write_index.load(std::memory_order_acquire);
+  cursor_ = written > header_->capacity ? written - header_->capacity : 0;
+  num_dropped_ = 0;
+  return true;
+#else
+  (void)name;
+  RCUTILS_LOG_ERROR("Telemetry needs POSIX shared memory, not available on this platform.");
+  return false;
+#endif
+}
+
+void TelemetryReader::detach()
+{
+#ifdef CONTROL_TOOLBOX_HAS_SHM
+  if (memory_ != nullptr) {
+    munmap(memory_, size_);
+  }
+#endif
+  memory_ = nullptr;
+  size_ = 0;
+  header_ = nullptr;
+  records_ = nullptr;
+  channels_.clear();
+}
+
+const std::vector<std::string> & TelemetryReader::getChannels() const { return channels_; }
+
+bool TelemetryReader::read(TelemetrySample & sample)
+{
+  if (header_ == nullptr) {
+    return false;
+  }
+
+  const uint64_t capacity = header_->capacity;
+  sample.values.resize(header_->num_channels);
+  for (;;) {
+    const uint64_t written = header_->write_index.load(std::memory_order_acquire);
+    if (cursor_ >= written) {
+      return false;
+    }
+    if (written - cursor_ > capacity) {
+      num_dropped_ += written - capacity - cursor_;
+      cursor_ = written - capacity;
+    }
+
+    const unsigned char * record = records_ + (cursor_ % capacity) * header_->record_size;
+    auto sequence = reinterpret_cast<const std::atomic<uint64_t> *>(record);
+    const uint64_t before = sequence->load(std::memory_order_acquire);
+    if (before == cursor_ + 1) {
+      std::memcpy(&sample.stamp, record + sizeof(uint64_t), sizeof(sample.stamp));
+      std::memcpy(
+        sample.values.data(), record + RECORD_HEADER_SIZE, sample.values.size() * sizeof(double));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence->load(std::memory_order_relaxed) == before) {
+        sample.index = cursor_++;
+        return true;
+      }
+    }
+    // The writer lapped the reader while it was copying the record
+    ++num_dropped_;
+    ++cursor_;
+  }
+}
+
+uint64_t TelemetryReader::getNumDropped() const { return num_dropped_; }
+
+}  // namespace control_toolbox
@@ -0,0 +1,215 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Stress tests of the handoff of gains and state between a realtime thread computing commands
+// and other threads setting gains, updating parameters and reading the state. Build with
+// -DCONTROL_TOOLBOX_TSAN=ON to run them under ThreadSanitizer.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/pid_ros.hpp"
+
+#include "gtest/gtest.h"
+#include "rclcpp/rclcpp.hpp"
+
+using control_toolbox::Pid;
+
+namespace
+{
+constexpr std::size_t CYCLES = 1000000;
+constexpr uint64_t DT = 1000000;
+
+// Runs the other threads while the realtime loop computes CYCLES commands, returns the
+// latency of each call in nanoseconds
+std::vector<double> runStress(
+  const std::function<void(std::size_t)> & cycle,
+  const std::vector<std::function<void()>> & contenders)
+{
+  std::atomic<bool> running{true};
+  std::vector<std::thread> threads;
+  for (const auto & contender : contenders) {
+    threads.emplace_back([&running, contender]() {
+      while (running.load(std::memory_order_relaxed)) {
+        contender();
+      }
+    });
+  }
+
+  std::vector<double> latencies(CYCLES);
+  std::thread realtime([&]() {
+    for (std::size_t k = 0; k < CYCLES; ++k) {
+      const auto start = std::chrono::steady_clock::now();
+      cycle(k);
+      latencies[k] =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+  });
+  realtime.join();
+
+  running = false;
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  return latencies;
+}
+
+// Logs the latency percentiles of the realtime loop, they depend on the machine and are not
+// checked
+void reportLatencies(testing::Test & test, std::vector<double> latencies)
+{
+  std::sort(latencies.begin(), latencies.end());
+  const auto percentile = [&latencies](double fraction) {
+    return latencies[static_cast<std::size_t>(fraction * (latencies.size() - 1))];
+  };
+  std::printf(
+    "computeCommand latency under contention: p50 %.0f ns, p99 %.0f ns, p99.9 %.0f ns, "
+    "max %.0f ns\n",
+    percentile(0.5), percentile(0.99), percentile(0.999), latencies.back());
+  test.RecordProperty("latency_p50_ns", std::to_string(percentile(0.5)));
+  test.RecordProperty("latency_p99_ns", std::to_string(percentile(0.99)));
+  test.RecordProperty("latency_p999_ns", std::to_string(percentile(0.999)));
+  test.RecordProperty("latency_max_ns", std::to_string(latencies.back()));
+}
+
+double errorAt(std::size_t cycle) { return 0.25 + 0.5 * static_cast<double>(cycle % 1000) / 1000; }
+}  // namespace
+
+class PidStressTest : public testing::Test
+{
+};
+
+TEST_F(PidStressTest, GainsAndStateTest)
+{
+  RecordProperty(
+    "description",
+    "This test sets and reads the gains and reads the state from several threads while a "
+    "realtime thread computes commands, and checks that no thread sees a mix of two gain sets "
+    "or of two updates.");
+
+  // Without integral gain, the command is 2 * error with the first set and 4 * error with the
+  // second, as the derivative error is always twice the error
+  const Pid::Gains first(1.0, 0.0, 0.5, 0.0, 0.0);
+  const Pid::Gains second(2.0, 0.0, 1.0, 0.0, 0.0);
+  Pid pid;
+  pid.setGains(first);
+
+  std::atomic<std::size_t> torn_commands{0}, torn_gains{0}, torn_states{0};
+  std::atomic<std::size_t> toggle{0};
+
+  const auto cycle = [&](std::size_t k) {
+    const double error = errorAt(k);
+    const double command = pid.computeCommand(error, 2.0 * error, DT);
+    if (command != 2.0 * error && command != 4.0 * error) {
+      ++torn_commands;
+    }
+  };
+  const auto set_gains = [&]() { pid.setGains(toggle++ % 2 == 0 ? first : second); };
+  const auto read_gains = [&]() {
+    const Pid::Gains gains = pid.getGainsNonRT();
+    if (!(gains.p_gain_ == 1.0 && gains.d_gain_ == 0.5) &&
+        !(gains.p_gain_ == 2.0 && gains.d_gain_ == 1.0)) {
+      ++torn_gains;
+    }
+  };
+  const auto read_state = [&]() {
+    double pe, ie, de;
+    pid.getCurrentPIDErrors(pe, ie, de);
+    if (de != 2.0 * pe) {
+      ++torn_states;
+    }
+  };
+
+  const std::vector<std::function<void()>> contenders = {
+    set_gains, set_gains, read_gains, read_gains, read_state, read_state};
+  reportLatencies(*this, runStress(cycle, contenders));
+  EXPECT_EQ(0u, torn_commands.load());
+  EXPECT_EQ(0u, torn_gains.load());
+  EXPECT_EQ(0u, torn_states.load());
+}
+
+TEST_F(PidStressTest, PidROSParameterUpdateTest)
+{
+  RecordProperty(
+    "description",
+    "This test updates the PidROS parameters from several threads while a realtime thread "
+    "computes and publishes commands, and checks that every command uses a consistent set of "
+    "gains.");
+
+  auto node = std::make_shared<rclcpp::Node>("concurrency_stress_test");
+  control_toolbox::PidROS pid_ros(node, "stress");
+  pid_ros.initPid(1.0, 0.0, 0.5, 0.0, 0.0, false);
+
+  std::atomic<std::size_t> torn_commands{0}, torn_states{0};
+  std::atomic<std::size_t> toggle{0};
+
+  // The derivative error is always twice the error, so the command is (p + 1) * error
+  const rclcpp::Duration dt = rclcpp::Duration::from_nanoseconds(DT);
+  const auto cycle = [&](std::size_t k) {
+    const double error = errorAt(k);
+    const double command = pid_ros.computeCommand(error, 2.0 * error, dt);
+    if (command != 2.0 * error && command != 3.0 * error) {
+      ++torn_commands;
+    }
+  };
+  const auto set_parameter = [&]() {
+    node->set_parameter(rclcpp::Parameter("stress.p", toggle++ % 2 == 0 ? 2.0 : 1.0));
+  };
+  const auto read_state = [&]() {
+    double pe, ie, de;
+    pid_ros.getCurrentPIDErrors(pe, ie, de);
+    if (de != 2.0 * pe) {
+      ++torn_states;
+    }
+  };
+
+  reportLatencies(*this, runStress(cycle, {set_parameter, set_parameter, read_state}));
+  EXPECT_EQ(0u, torn_commands.load());
+  EXPECT_EQ(0u, torn_states.load());
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(0, nullptr);
+  const int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <deque>
+
+#include "control_toolbox/delay_estimator.hpp"
+#include "control_toolbox/dither.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::DelayEstimator;
+
+TEST(DelayEstimatorTest, IntegerDelayTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the delay of a scaled and delayed copy of white noise is found, and "
+    "that a change of the delay is tracked, and that samples which are not finite are ignored.");
+
+  control_toolbox::Dither excitation, noise;
+  ASSERT_TRUE(excitation.init(1.0, 1));
+  ASSERT_TRUE(noise.init(0.2, 2));
+
+  DelayEstimator estimator;
+  ASSERT_TRUE(estimator.init(20, 0.999));
+
+  std::deque<double> line(30, 0.0);
+  size_t delay = 7;
+  for (int n = 0; n < 20000; ++n) {
+    if (n == 10000) {
+      delay = 12;
+    }
+    double u = excitation.update();
+    line.push_front(u);
+    line.pop_back();
+    estimator.update(u, 0.5 + 2.0 * line[delay] + noise.update());
+    if (n % 1000 == 0) {
+      estimator.update(u, INFINITY);
+      estimator.update(-INFINITY, u);
+      estimator.update(std::nan(""), u);
+    }
+
+    if (n == 9999) {
+      EXPECT_NEAR(7.0, estimator.getDelay(), 0.1);
+      EXPECT_GT(estimator.getConfidence(), 0.9);
+    }
+  }
+  EXPECT_NEAR(12.0, estimator.getDelay(), 0.1);
+  EXPECT_TRUE(std::isfinite(estimator.getConfidence()));
+  EXPECT_GT(estimator.getCorrelation(12), 10.0 * std::abs(estimator.getCorrelation(7)));
+}
+
+TEST(DelayEstimatorTest, FractionalDelayTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a delay between two samples is interpolated, and that an inverted "
+    "response gives a negative confidence.");
+
+  control_toolbox::Dither excitation;
+  ASSERT_TRUE(excitation.init(1.0, 3));
+
+  DelayEstimator estimator;
+  ASSERT_TRUE(estimator.init(10, 0.999));
+
+  std::deque<double> line(10, 0.0);
+  for (int n = 0; n < 10000; ++n) {
+    double u = excitation.update();
+    line.push_front(u);
+    line.pop_back();
+    estimator.update(u, -(0.5 * line[4] + 0.5 * line[5]));
+  }
+  EXPECT_NEAR(4.5, estimator.getDelay(), 0.25);
+  EXPECT_LT(estimator.getConfidence(), -0.5);
+}
+
+TEST(DelayEstimatorTest, InitTest)
+{
+  RecordProperty(
+    "description", "This test checks bad settings and the behaviour before initialization.");
+
+  DelayEstimator estimator;
+  EXPECT_FALSE(estimator.init(10, 1.0));
+  EXPECT_FALSE(estimator.init(10, 0.0));
+
+  estimator.update(1.0, 1.0);
+  EXPECT_EQ(0.0, estimator.getDelay());
+  EXPECT_EQ(0.0, estimator.getConfidence());
+  EXPECT_EQ(0.0, estimator.getCorrelation(3));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,239 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "control_toolbox/dither.hpp"
+#include "control_toolbox/frequency_response.hpp"
+#include "control_toolbox/sine_sweep.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::FrequencyResponse;
+using control_toolbox::FrequencyResponseEstimator;
+using control_toolbox::Pid;
+using control_toolbox::StabilityMargins;
+
+namespace
+{
+// First order low pass y[k] = a y[k-1] + (1 - a) x[k]
+std::vector<double> lowPass(const std::vector<double> & input, double a)
+{
+  std::vector<double> output(input.size());
+  double y = 0.0;
+  for (size_t k = 0; k < input.size(); ++k) {
+    y = a * y + (1.0 - a) * input[k];
+    output[k] = y;
+  }
+  return output;
+}
+
+std::complex<double> lowPassResponse(double a, double frequency, double sample_rate)
+{
+  std::complex<double> z_inv = std::polar(1.0, -2.0 * M_PI * frequency / sample_rate);
+  return (1.0 - a) / (1.0 - a * z_inv);
+}
+
+// Analytic frequency response of a continuous plant on a logarithmic grid
+template <typename PlantT>
+FrequencyResponse analyticResponse(PlantT plant)
+{
+  FrequencyResponse response;
+  for (double f = 1e-3; f < 1e2; f *= 1.01) {
+    response.frequencies.push_back(f);
+    response.response.push_back(plant(std::complex<double>(0.0, 2.0 * M_PI * f)));
+  }
+  return response;
+}
+}  // namespace
+
+TEST(FrequencyResponseTest, WhiteNoiseEstimateTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the H1 estimate of a known low pass filter excited with white noise "
+    "matches its analytic response.");
+
+  const double sample_rate = 1000.0;
+  const double a = 0.9;
+
+  control_toolbox::Dither dither;
+  ASSERT_TRUE(dither.init(1.0, 42));
+  std::vector<double> input(1 << 16);
+  for (auto & x : input) {
+    x = dither.update();
+  }
+  std::vector<double> output = lowPass(input, a);
+
+  FrequencyResponseEstimator estimator;
+  ASSERT_TRUE(estimator.init(1024, 0.5, sample_rate));
+  FrequencyResponse response;
+  ASSERT_TRUE(estimator.estimate(input, output, response));
+
+  ASSERT_EQ(512u, response.frequencies.size());
+  EXPECT_DOUBLE_EQ(sample_rate / 1024, response.frequencies.front());
+  EXPECT_DOUBLE_EQ(sample_rate / 2, response.frequencies.back());
+
+  for (size_t k = 0; k < response.frequencies.size(); k += 50) {
+    std::complex<double> expected = lowPassResponse(a, response.frequencies[k], sample_rate);
+    EXPECT_NEAR(std::abs(expected), std::abs(response.response[k]), 0.05 * std::abs(expected));
+    EXPECT_NEAR(std::arg(expected), std::arg(response.response[k]), 0.05);
+    EXPECT_GT(response.coherence[k], 0.95);
+  }
+}
+
+TEST(FrequencyResponseTest, SineSweepThreadsTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a sweep generated with SineSweep gives the same estimate with one or "
+    "several worker threads.");
+
+  const double sample_rate = 1000.0;
+  control_toolbox::SineSweep sweep;
+  ASSERT_TRUE(sweep.init(1.0, 400.0, 20.0, 1.0));
+  std::vector<double> input(20000);
+  for (size_t k = 0; k < input.size(); ++k) {
+    input[k] = sweep.update(rclcpp::Duration::from_seconds(k / sample_rate));
+  }
+  std::vector<double> output = lowPass(input, 0.8);
+
+  FrequencyResponseEstimator single, multi;
+  ASSERT_TRUE(single.init(512, 0.75, sample_rate, 1));
+  ASSERT_TRUE(multi.init(512, 0.75, sample_rate, 4));
+  FrequencyResponse single_response, multi_response;
+  ASSERT_TRUE(single.estimate(input, output, single_response));
+  ASSERT_TRUE(multi.estimate(input, output, multi_response));
+
+  ASSERT_EQ(single_response.response.size(), multi_response.response.size());
+  for (size_t k = 0; k < single_response.response.size(); ++k) {
+    EXPECT_NEAR(
+      std::abs(single_response.response[k] - multi_response.response[k]), 0.0,
+      1e-9 * std::abs(single_response.response[k]));
+  }
+}
+
+TEST(FrequencyResponseTest, BadInputTest)
+{
+  RecordProperty(
+    "description", "This test checks that invalid settings and records are rejected.");
+
+  FrequencyResponseEstimator estimator;
+  FrequencyResponse response;
+  std::vector<double> data(100, 0.0);
+  EXPECT_FALSE(estimator.estimate(data, data, response));
+  EXPECT_FALSE(estimator.init(1000, 0.5, 100.0));
+  EXPECT_FALSE(estimator.init(256, 1.0, 100.0));
+  EXPECT_FALSE(estimator.init(256, 0.5, 0.0));
+  ASSERT_TRUE(estimator.init(256, 0.5, 100.0));
+  EXPECT_FALSE(estimator.estimate(data, data, response));
+}
+
+TEST(StabilityMarginsTest, PhaseMarginTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks the phase margin of a proportional controller on the plant 1/(s(s+1)).");
+
+  FrequencyResponse plant =
+    analyticResponse([](std::complex<double> s) { return 1.0 / (s * (s + 1.0)); });
+  FrequencyResponse loop;
+  computeLoopResponse(plant, Pid::Gains(1.0, 0.0, 0.0, 0.0, 0.0), loop);
+
+  StabilityMargins margins;
+  ASSERT_TRUE(computeStabilityMargins(loop, margins));
+
+  // |L(jw)| = 1 for w^2 = (sqrt(5) - 1) / 2
+  const double w = std::sqrt((std::sqrt(5.0) - 1.0) / 2.0);
+  EXPECT_NEAR(w / (2.0 * M_PI), margins.gain_crossover_frequency, 1e-3);
+  EXPECT_NEAR(90.0 - std::atan(w) * 180.0 / M_PI, margins.phase_margin, 0.1);
+  EXPECT_TRUE(std::isinf(margins.gain_margin));
+}
+
+TEST(StabilityMarginsTest, GainMarginTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks the gain margin of a proportional controller on the plant 1/(s+1)^3.");
+
+  FrequencyResponse plant = analyticResponse(
+    [](std::complex<double> s) { return 1.0 / ((s + 1.0) * (s + 1.0) * (s + 1.0)); });
+  FrequencyResponse loop;
+  computeLoopResponse(plant, Pid::Gains(4.0, 0.0, 0.0, 0.0, 0.0), loop);
+
+  StabilityMargins margins;
+  ASSERT_TRUE(computeStabilityMargins(loop, margins));
+
+  // The phase reaches -180 degrees at w = sqrt(3), where |L| = 4 / 8
+  EXPECT_NEAR(std::sqrt(3.0) / (2.0 * M_PI), margins.phase_crossover_frequency, 1e-3);
+  EXPECT_NEAR(2.0, margins.gain_margin, 1e-2);
+}
+
+TEST(StabilityMarginsTest, BandwidthTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks the closed loop bandwidth of a proportional controller on an integrator.");
+
+  FrequencyResponse plant = analyticResponse([](std::complex<double> s) { return 1.0 / s; });
+  FrequencyResponse loop;
+  const double k = 5.0;
+  computeLoopResponse(plant, Pid::Gains(k, 0.0, 0.0, 0.0, 0.0), loop);
+
+  StabilityMargins margins;
+  ASSERT_TRUE(computeStabilityMargins(loop, margins));
+  EXPECT_NEAR(k / (2.0 * M_PI), margins.bandwidth, 1e-2);
+  EXPECT_NEAR(90.0, margins.phase_margin, 0.1);
+}
+
+TEST(StabilityMarginsTest, DiscretePidTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the discrete Pid response matches the continuous one at low "
+    "frequencies.");
+
+  Pid::Gains gains(2.0, 3.0, 0.1, 0.0, 0.0);
+  for (double f : {0.1, 1.0, 5.0}) {
+    std::complex<double> continuous = control_toolbox::evaluatePidResponse(gains, f, 0.0);
+    std::complex<double> discrete = control_toolbox::evaluatePidResponse(gains, f, 10000.0);
+    EXPECT_NEAR(std::abs(continuous), std::abs(discrete), 1e-2 * std::abs(continuous));
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+
+#include "control_toolbox/dither.hpp"
+#include "control_toolbox/friction_compensation.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::FrictionCompensator;
+using control_toolbox::FrictionIdentifier;
+using control_toolbox::FrictionParameters;
+
+namespace
+{
+FrictionParameters referenceParameters()
+{
+  FrictionParameters parameters;
+  parameters.coulomb = 1.0;
+  parameters.static_friction = 1.5;
+  parameters.viscous = 0.4;
+  parameters.stribeck_velocity = 0.05;
+  return parameters;
+}
+}  // namespace
+
+TEST(FrictionIdentifierTest, FitTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the friction parameters are recovered from noisy samples of a slow "
+    "sweep in both directions.");
+
+  const FrictionParameters reference = referenceParameters();
+  control_toolbox::Dither noise;
+  ASSERT_TRUE(noise.init(0.01, 7));
+
+  FrictionIdentifier identifier;
+  ASSERT_TRUE(identifier.init(0.005, 0.5, 1e-4));
+
+  for (double v = 0.002; v < 2.0; v *= 1.05) {
+    identifier.addSample(v, computeFrictionForce(reference, v) + noise.update());
+    identifier.addSample(-v, computeFrictionForce(reference, -v) + noise.update());
+  }
+  // Samples inside the deadband are ignored
+  identifier.addSample(0.0, 10.0);
+  identifier.addSample(5e-5, 10.0);
+
+  FrictionParameters fitted;
+  ASSERT_TRUE(identifier.fit(fitted));
+  EXPECT_NEAR(reference.coulomb, fitted.coulomb, 0.02);
+  EXPECT_NEAR(reference.static_friction, fitted.static_friction, 0.05);
+  EXPECT_NEAR(reference.viscous, fitted.viscous, 0.02);
+  EXPECT_NEAR(reference.stribeck_velocity, fitted.stribeck_velocity, 0.01);
+
+  identifier.reset();
+  EXPECT_EQ(0u, identifier.getNumSamples());
+  EXPECT_FALSE(identifier.fit(fitted));
+}
+
+TEST(FrictionIdentifierTest, NoSlowSamplesTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that Coulomb and viscous friction are found when there is no sample slow "
+    "enough to see the Stribeck effect.");
+
+  FrictionParameters reference;
+  reference.coulomb = 0.3;
+  reference.viscous = 2.0;
+
+  FrictionIdentifier identifier;
+  ASSERT_TRUE(identifier.init(0.001, 0.01));
+  for (double v = 0.5; v < 2.0; v += 0.1) {
+    identifier.addSample(v, computeFrictionForce(reference, v));
+    identifier.addSample(-v, computeFrictionForce(reference, -v));
+  }
+
+  FrictionParameters fitted;
+  ASSERT_TRUE(identifier.fit(fitted));
+  EXPECT_NEAR(reference.coulomb, fitted.coulomb, 1e-6);
+  EXPECT_NEAR(reference.viscous, fitted.viscous, 1e-6);
+  EXPECT_TRUE(std::isfinite(fitted.static_friction));
+}
+
+TEST(FrictionCompensatorTest, TableTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the tabulated compensation follows the model, ramps through zero "
+    "velocity and extrapolates beyond the table.");
+
+  const FrictionParameters parameters = referenceParameters();
+  FrictionCompensator compensator;
+  EXPECT_EQ(0.0, compensator.compute(1.0));
+  EXPECT_FALSE(compensator.init(parameters, 0.0, 100, 0.0));
+  ASSERT_TRUE(compensator.init(parameters, 1.0, 2001, 0.001));
+
+  for (double v = 0.01; v < 1.0; v += 0.01) {
+    EXPECT_NEAR(computeFrictionForce(parameters, v), compensator.compute(v), 1e-3);
+    EXPECT_NEAR(computeFrictionForce(parameters, -v), compensator.compute(-v), 1e-3);
+  }
+  EXPECT_NEAR(0.0, compensator.compute(0.0), 1e-12);
+  EXPECT_LT(std::abs(compensator.compute(0.0005)), parameters.static_friction);
+  EXPECT_DOUBLE_EQ(computeFrictionForce(parameters, 3.0), compensator.compute(3.0));
+  EXPECT_DOUBLE_EQ(computeFrictionForce(parameters, -1.0), compensator.compute(-1.0));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
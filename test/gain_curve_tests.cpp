@@ -0,0 +1,148 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "control_toolbox/gain_curve.hpp"
+#include "control_toolbox/pid.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::GainCurve;
+using control_toolbox::Pid;
+
+TEST(GainCurveTest, PiecewiseLinearTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks the interpolation of a piecewise linear curve, including uneven and "
+    "closely spaced breakpoints.");
+
+  std::shared_ptr<const GainCurve> curve =
+    GainCurve::createPiecewiseLinear({0.1, 0.2, 0.201, 1.0, 3.0}, {0.5, 1.0, 1.5, 2.0, 2.0});
+  ASSERT_TRUE(curve);
+
+  EXPECT_EQ(0.5, curve->evaluate(0.0));
+  EXPECT_EQ(0.5, curve->evaluate(-0.05));
+  EXPECT_DOUBLE_EQ(0.75, curve->evaluate(0.15));
+  EXPECT_DOUBLE_EQ(0.75, curve->evaluate(-0.15));
+  EXPECT_DOUBLE_EQ(1.25, curve->evaluate(0.2005));
+  EXPECT_DOUBLE_EQ(1.5 + 0.5 * 0.299 / 0.799, curve->evaluate(0.5));
+  EXPECT_EQ(2.0, curve->evaluate(10.0));
+
+  // Compare with a linear search over the whole range
+  const double errors[] = {0.1, 0.2, 0.201, 1.0, 3.0};
+  const double scales[] = {0.5, 1.0, 1.5, 2.0, 2.0};
+  for (double x = 0.1; x < 3.0; x += 1e-4) {
+    size_t k = 0;
+    while (x >= errors[k + 1]) {
+      ++k;
+    }
+    const double expected =
+      scales[k] + (scales[k + 1] - scales[k]) * (x - errors[k]) / (errors[k + 1] - errors[k]);
+    EXPECT_NEAR(expected, curve->evaluate(x), 1e-12);
+  }
+
+  EXPECT_FALSE(GainCurve::createPiecewiseLinear({0.0, 0.0}, {1.0, 2.0}));
+  EXPECT_FALSE(GainCurve::createPiecewiseLinear({-1.0, 0.0}, {1.0, 2.0}));
+  EXPECT_FALSE(GainCurve::createPiecewiseLinear({0.0, 1.0}, {1.0}));
+}
+
+TEST(GainCurveTest, ClusteredBreakpointsTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a tight cluster of breakpoints, which the grid cannot separate, is "
+    "rejected, and that the finest accepted grid evaluates exactly.");
+
+  EXPECT_FALSE(GainCurve::createPiecewiseLinear({0.0, 1.0, 1.0 + 1e-6, 2.0}, {1.0, 1.0, 2.0, 2.0}));
+
+  const std::size_t size = GainCurve::MAX_GRID_CELLS;
+  std::vector<double> errors(size), scales(size);
+  for (std::size_t k = 0; k < size; ++k) {
+    errors[k] = static_cast<double>(k);
+    scales[k] = (k % 2 == 0) ? 1.0 : 2.0;
+  }
+  std::shared_ptr<const GainCurve> curve = GainCurve::createPiecewiseLinear(errors, scales);
+  ASSERT_TRUE(curve);
+  for (std::size_t k = 0; k + 1 < size; k += 101) {
+    EXPECT_DOUBLE_EQ(k % 2 == 0 ? 1.25 : 1.75, curve->evaluate(k + 0.25));
+  }
+}
+
+TEST(GainCurveTest, PolynomialTest)
+{
+  RecordProperty("description", "This test checks the evaluation of a polynomial curve.");
+
+  std::shared_ptr<const GainCurve> curve = GainCurve::createPolynomial({1.0, 0.0, 2.0}, 2.0);
+  ASSERT_TRUE(curve);
+  EXPECT_DOUBLE_EQ(1.0, curve->evaluate(0.0));
+  EXPECT_DOUBLE_EQ(1.5, curve->evaluate(-0.5));
+  EXPECT_DOUBLE_EQ(9.0, curve->evaluate(5.0));
+  EXPECT_FALSE(GainCurve::createPolynomial({}, 1.0));
+}
+
+TEST(GainCurveTest, PidContinuityTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a Pid with a gain curve scales its proportional term and that its "
+    "output is continuous across the breakpoints.");
+
+  Pid pid(2.0, 0.0, 0.0, 0.0, 0.0);
+  pid.setGainCurve(GainCurve::createPiecewiseLinear({0.1, 1.0}, {0.25, 1.0}));
+  ASSERT_TRUE(pid.getGainCurve());
+
+  EXPECT_DOUBLE_EQ(2.0 * 0.25 * 0.05, pid.computeCommand(0.05, 0.0, 1000000));
+  EXPECT_DOUBLE_EQ(-2.0 * 1.0 * 2.0, pid.computeCommand(-2.0, 0.0, 1000000));
+
+  const double eps = 1e-9;
+  for (double breakpoint : {0.1, 1.0, -0.1, -1.0}) {
+    const double before = pid.computeCommand(breakpoint - eps, 0.0, 1000000);
+    const double after = pid.computeCommand(breakpoint + eps, 0.0, 1000000);
+    EXPECT_NEAR(before, after, 10 * eps);
+  }
+
+  // Copies share the curve, removing it restores the plain proportional term
+  Pid copy(pid);
+  EXPECT_EQ(pid.getGainCurve(), copy.getGainCurve());
+  pid.setGainCurve(nullptr);
+  EXPECT_DOUBLE_EQ(2.0 * 0.05, pid.computeCommand(0.05, 0.0, 1000000));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,276 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "control_toolbox/gain_schedule.hpp"
+#include "control_toolbox/limited_proxy.hpp"
+#include "control_toolbox/pid.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::GainSchedule;
+using control_toolbox::LimitedProxyParameters;
+using control_toolbox::Pid;
+
+namespace
+{
+std::string uniquePath(const std::string & suffix)
+{
+  // Unique per process, so tests running in parallel do not share files
+  return "/tmp/control_toolbox_test_" + std::to_string(getpid()) + "_" + suffix;
+}
+
+LimitedProxyParameters proxyParameters(double scale)
+{
+  LimitedProxyParameters parameters;
+  parameters.mass = scale;
+  parameters.Kp = 10.0 * scale;
+  parameters.Kd = 2.0 * scale;
+  parameters.effort_limit = 100.0 * scale;
+  parameters.acc_converge = 0.5 * scale;
+  return parameters;
+}
+}  // namespace
+
+TEST(GainScheduleTest, LookupTest)
+{
+  RecordProperty(
+    "description",
+    "This test writes and loads a schedule, then checks the interpolation of the gains and the "
+    "selection of the proxy parameters.");
+
+  const std::string path = uniquePath("lookup");
+  ASSERT_TRUE(GainSchedule::write(
+    path, {0.0, 1.0, 3.0},
+    {Pid::Gains(1.0, 0.1, 0.01, 1.0, -1.0, false), Pid::Gains(2.0, 0.2, 0.02, 2.0, -2.0, true),
+     Pid::Gains(4.0, 0.4, 0.04, 4.0, -4.0, false)},
+    {-1.0, 2.0}, {proxyParameters(1.0), proxyParameters(2.0)}));
+  std::shared_ptr<const GainSchedule> schedule = GainSchedule::load(path);
+  std::remove(path.c_str());
+  ASSERT_TRUE(schedule);
+  EXPECT_EQ(3u, schedule->getNumGains());
+  EXPECT_EQ(2u, schedule->getNumProxyParameters());
+
+  // Constant beyond the breakpoints, linear in between
+  EXPECT_EQ(1.0, schedule->getGains(-5.0).p_gain_);
+  EXPECT_EQ(4.0, schedule->getGains(5.0).p_gain_);
+  EXPECT_EQ(2.0, schedule->getGains(1.0).p_gain_);
+  Pid::Gains gains = schedule->getGains(2.0);
+  EXPECT_DOUBLE_EQ(3.0, gains.p_gain_);
+  EXPECT_DOUBLE_EQ(0.3, gains.i_gain_);
+  EXPECT_DOUBLE_EQ(0.03, gains.d_gain_);
+  EXPECT_DOUBLE_EQ(3.0, gains.i_max_);
+  EXPECT_DOUBLE_EQ(-3.0, gains.i_min_);
+  EXPECT_TRUE(gains.antiwindup_);
+  EXPECT_FALSE(schedule->getGains(0.5).antiwindup_);
+
+  // Proxy parameters of the breakpoint below
+  EXPECT_EQ(1.0, schedule->getProxyParameters(-2.0).mass);
+  EXPECT_EQ(1.0, schedule->getProxyParameters(1.9).mass);
+  EXPECT_EQ(2.0, schedule->getProxyParameters(2.0).mass);
+  control_toolbox::LimitedProxy proxy;
+  schedule->getProxyParameters(10.0).applyTo(proxy);
+  EXPECT_EQ(20.0, proxy.Kp_);
+  EXPECT_EQ(4.0, proxy.Kd_);
+  EXPECT_EQ(200.0, proxy.effort_limit_);
+  EXPECT_EQ(1.0, proxy.acc_converge_);
+}
+
+TEST(GainScheduleTest, InvalidFileTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that invalid tables are not written and that missing, truncated, "
+    "corrupted and foreign files are not loaded.");
+
+  const std::string path = uniquePath("invalid");
+  const std::vector<Pid::Gains> gains(2, Pid::Gains(1.0, 0.0, 0.0, 0.0, 0.0));
+  EXPECT_FALSE(GainSchedule::write(path, {1.0, 1.0}, gains));
+  EXPECT_FALSE(GainSchedule::write(path, {1.0}, gains));
+  EXPECT_FALSE(GainSchedule::write(path, {}, {}));
+  const Pid::Gains invalid(std::nan(""), 0.0, 0.0, 0.0, 0.0);
+  EXPECT_FALSE(GainSchedule::write(path, {0.0, 1.0}, {gains[0], invalid}));
+  EXPECT_FALSE(GainSchedule::load(path));
+
+  ASSERT_TRUE(GainSchedule::write(path, {0.0, 1.0}, gains));
+  std::FILE * file = std::fopen(path.c_str(), "rb");
+  ASSERT_NE(nullptr, file);
+  std::vector<char> content(1 << 12);
+  content.resize(std::fread(content.data(), 1, content.size(), file));
+  std::fclose(file);
+
+  const auto load_modified = [&path](std::vector<char> modified) {
+    std::FILE * out = std::fopen(path.c_str(), "wb");
+    std::fwrite(modified.data(), 1, modified.size(), out);
+    std::fclose(out);
+    return GainSchedule::load(path);
+  };
+  EXPECT_TRUE(load_modified(content));
+
+  std::vector<char> corrupted = content;
+  corrupted.back() ^= 1;
+  EXPECT_FALSE(load_modified(corrupted));
+
+  std::vector<char> truncated(content.begin(), content.end() - 8);
+  EXPECT_FALSE(load_modified(truncated));
+
+  std::vector<char> foreign = content;
+  foreign[0] = 'X';
+  EXPECT_FALSE(load_modified(foreign));
+
+  EXPECT_FALSE(load_modified(std::vector<char>(10, 0)));
+  std::remove(path.c_str());
+}
+
+TEST(GainScheduleTest, LargeScheduleTest)
+{
+  RecordProperty(
+    "description",
+    "This test loads a schedule of 50000 breakpoints, twice as two users of the same file would, "
+    "and checks lookups against the tables it was written from.");
+
+  const std::size_t size = 50000;
+  std::vector<double> breakpoints(size);
+  std::vector<Pid::Gains> gains(size);
+  for (std::size_t k = 0; k < size; ++k) {
+    breakpoints[k] = 0.001 * k * k;
+    gains[k] = Pid::Gains(k, 2.0 * k, 0.0, 1.0, -1.0);
+  }
+  const std::string path = uniquePath("large");
+  ASSERT_TRUE(GainSchedule::write(path, breakpoints, gains));
+
+  const auto start = std::chrono::steady_clock::now();
+  std::shared_ptr<const GainSchedule> first = GainSchedule::load(path);
+  const double load_time =
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  std::shared_ptr<const GainSchedule> second = GainSchedule::load(path);
+  std::remove(path.c_str());
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  RecordProperty("load_time_ms", std::to_string(load_time));
+
+  for (std::size_t k = 0; k + 1 < size; k += 997) {
+    EXPECT_EQ(static_cast<double>(k), first->getGains(breakpoints[k]).p_gain_);
+    const double middle = 0.5 * (breakpoints[k] + breakpoints[k + 1]);
+    EXPECT_DOUBLE_EQ(k + 0.5, first->getGains(middle).p_gain_);
+    EXPECT_DOUBLE_EQ(2.0 * k + 1.0, second->getGains(middle).i_gain_);
+  }
+  EXPECT_EQ(0u, first->getNumProxyParameters());
+  EXPECT_EQ(0.0, first->getProxyParameters(1.0).mass);
+}
+
+TEST(GainScheduleTest, PidScheduleTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a Pid uses the gains of its schedule at the scheduling variable, and "
+    "its own gains again once the schedule is removed.");
+
+  const std::string path = uniquePath("pid");
+  ASSERT_TRUE(GainSchedule::write(
+    path, {0.0, 10.0},
+    {Pid::Gains(1.0, 0.0, 0.0, 0.0, 0.0), Pid::Gains(11.0, 0.0, 0.0, 0.0, 0.0)}));
+  std::shared_ptr<const GainSchedule> schedule = GainSchedule::load(path);
+  std::remove(path.c_str());
+  ASSERT_TRUE(schedule);
+
+  Pid pid(0.5, 0.0, 0.0, 0.0, 0.0);
+  const uint64_t dt = 1000000;
+  EXPECT_EQ(0.5, pid.computeCommand(1.0, 0.0, dt));
+
+  pid.setGainSchedule(schedule);
+  EXPECT_EQ(schedule, pid.getGainSchedule());
+  EXPECT_EQ(1.0, pid.computeCommand(1.0, 0.0, dt));
+  pid.setScheduleVariable(5.0);
+  EXPECT_EQ(6.0, pid.computeCommand(1.0, 0.0, dt));
+  EXPECT_EQ(6.0, pid.getActiveGains().p_gain_);
+  EXPECT_EQ(0.5, pid.getGainsNonRT().p_gain_);
+
+  pid.setGainSchedule(nullptr);
+  EXPECT_EQ(0.5, pid.computeCommand(1.0, 0.0, dt));
+}
+
+TEST(GainScheduleTest, PidScheduleRampTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a ramp toward a schedule ends on the scheduled gains while the "
+    "scheduling variable moves, and that the gains then follow the schedule exactly.");
+
+  const std::string path = uniquePath("ramp");
+  ASSERT_TRUE(GainSchedule::write(
+    path, {0.0, 10.0},
+    {Pid::Gains(1.0, 0.0, 0.0, 0.0, 0.0), Pid::Gains(11.0, 0.0, 0.0, 0.0, 0.0)}));
+  std::shared_ptr<const GainSchedule> schedule = GainSchedule::load(path);
+  std::remove(path.c_str());
+  ASSERT_TRUE(schedule);
+
+  Pid pid(0.5, 0.0, 0.0, 0.0, 0.0);
+  pid.setGainRampCycles(10);
+  pid.setGainSchedule(schedule);
+  const uint64_t dt = 1000000;
+  double last = 0.5;
+  for (int k = 1; k <= 30; ++k) {
+    const double variable = 0.1 * k;
+    pid.setScheduleVariable(variable);
+    pid.computeCommand(1.0, 0.0, dt);
+    const double p = pid.getActiveGains().p_gain_;
+    if (k < 10) {
+      EXPECT_GT(p, last);
+      EXPECT_LT(p, 1.0 + variable);
+    } else {
+      EXPECT_DOUBLE_EQ(1.0 + variable, p);
+    }
+    last = p;
+  }
+
+  // Removing the schedule ramps back to the gains set
+  pid.setGainSchedule(nullptr);
+  for (int k = 1; k <= 10; ++k) {
+    pid.computeCommand(1.0, 0.0, dt);
+    EXPECT_DOUBLE_EQ(4.0 - 0.35 * k, pid.getActiveGains().p_gain_);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
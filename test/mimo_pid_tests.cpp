@@ -0,0 +1,137 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <array>
+#include <cmath>
+
+#include "control_toolbox/mimo_pid.hpp"
+#include "control_toolbox/pid.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::MimoPid;
+using control_toolbox::Pid;
+
+TEST(MimoPidTest, DiagonalMatchesPidTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that diagonal gains behave as one Pid per axis, including the integral "
+    "clamp and mixed antiwindup settings.");
+
+  const std::array<Pid::Gains, 3> axes = {
+    Pid::Gains(1.0, 2.0, 0.1, 0.5, -0.5, true), Pid::Gains(3.0, 1.0, 0.0, 2.0, -1.0),
+    Pid::Gains(0.5, 0.0, 0.2, 0.0, 0.0)};
+
+  MimoPid<3> mimo;
+  mimo.setGains(MimoPid<3>::diagonalGains(axes));
+  std::array<Pid, 3> pids;
+  for (size_t k = 0; k < 3; ++k) {
+    pids[k].setGains(axes[k]);
+    pids[k].reset();
+  }
+
+  const uint64_t dt = 1000000;
+  for (int n = 0; n < 2000; ++n) {
+    MimoPid<3>::InputVector error;
+    for (size_t k = 0; k < 3; ++k) {
+      error[k] = std::sin(0.005 * n * (k + 1)) + 0.3;
+    }
+    const MimoPid<3>::OutputVector cmd = mimo.computeCommand(error, dt);
+    for (size_t k = 0; k < 3; ++k) {
+      EXPECT_NEAR(pids[k].computeCommand(error[k], dt), cmd[k], 1e-9);
+    }
+  }
+}
+
+TEST(MimoPidTest, DecouplingTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the decoupling matrix mixes the pid outputs, and that the integral is "
+    "clamped per output with antiwindup.");
+
+  // Two motors driving the sum and the difference of two axes
+  MimoPid<2, 2>::Gains gains;
+  gains.p = {2.0, 0.0, 0.0, 4.0};
+  gains.i = {1.0, 0.0, 0.0, 1.0};
+  gains.decoupling = {0.5, 0.5, 0.5, -0.5};
+  gains.i_max = {0.25, 10.0};
+  gains.i_min = {-0.25, -10.0};
+  gains.antiwindup = {true, true};
+
+  MimoPid<2, 2> mimo;
+  mimo.setGains(gains);
+  EXPECT_EQ(0.5, mimo.getGains().decoupling[1]);
+
+  const uint64_t dt = 100000000;
+  MimoPid<2, 2>::OutputVector cmd = mimo.computeCommand({1.0, 0.5}, {0.0, 0.0}, dt);
+  EXPECT_NEAR(0.5 * (2.0 + 2.0) + 0.5 * (0.1 + 0.05), cmd[0], 1e-12);
+  EXPECT_NEAR(0.5 * (2.0 - 2.0) + 0.5 * (0.1 - 0.05), cmd[1], 1e-12);
+
+  // The integral of the first output saturates at 0.25, the second one keeps growing
+  for (int n = 0; n < 100; ++n) {
+    cmd = mimo.computeCommand({1.0, 0.5}, {0.0, 0.0}, dt);
+  }
+  EXPECT_NEAR(0.25, mimo.getIntegralTerm()[0], 1e-12);
+  EXPECT_NEAR(101 * 0.1 * 0.5 * (1.0 - 0.5), mimo.getIntegralTerm()[1], 1e-9);
+
+  // Invalid inputs give zero commands
+  cmd = mimo.computeCommand({NAN, 0.0}, 1000);
+  EXPECT_EQ(0.0, cmd[0]);
+  cmd = mimo.computeCommand({1.0, 0.0}, 0);
+  EXPECT_EQ(0.0, cmd[1]);
+}
+
+TEST(MimoPidTest, NonSquareTest)
+{
+  RecordProperty(
+    "description", "This test checks a controller with more outputs than inputs.");
+
+  MimoPid<1, 2>::Gains gains;
+  gains.p = {1.0, -3.0};
+  MimoPid<1, 2> mimo;
+  mimo.setGains(gains);
+  MimoPid<1, 2>::OutputVector cmd = mimo.computeCommand({2.0}, 1000000);
+  EXPECT_DOUBLE_EQ(2.0, cmd[0]);
+  EXPECT_DOUBLE_EQ(-6.0, cmd[1]);
+
+  MimoPid<1, 2> copy(mimo);
+  EXPECT_EQ(-3.0, copy.getGains().p[1]);
+  EXPECT_EQ(0.0, copy.getCurrentCmd()[0]);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,172 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "control_toolbox/notch_filter.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::BiquadCoefficients;
+using control_toolbox::FrequencyResponse;
+using control_toolbox::NotchFilter;
+using control_toolbox::Resonance;
+
+namespace
+{
+// Structural mode with a resonance at f, the ratio of damping sets its height
+std::complex<double> mode(std::complex<double> s, double f, double zeta_zero, double zeta_pole)
+{
+  const double w = 2.0 * M_PI * f;
+  return (s * s + 2.0 * zeta_zero * w * s + w * w) / (s * s + 2.0 * zeta_pole * w * s + w * w);
+}
+
+FrequencyResponse twoModePlant()
+{
+  FrequencyResponse response;
+  for (double f = 1.0; f < 200.0; f *= 1.002) {
+    std::complex<double> s(0.0, 2.0 * M_PI * f);
+    response.frequencies.push_back(f);
+    response.response.push_back(
+      1.0 / (s / 10.0 + 1.0) * mode(s, 20.0, 0.3, 0.02) * mode(s, 60.0, 0.2, 0.02));
+  }
+  return response;
+}
+}  // namespace
+
+TEST(NotchFilterTest, DesignTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a designed notch has the requested gain at its center frequency and "
+    "unit gain far from it.");
+
+  const double sample_rate = 1000.0;
+  BiquadCoefficients notch = control_toolbox::designNotch(50.0, 10.0, 0.1, sample_rate);
+
+  EXPECT_NEAR(0.1, std::abs(notch.response(50.0, sample_rate)), 1e-9);
+  EXPECT_NEAR(1.0, std::abs(notch.response(0.0, sample_rate)), 1e-9);
+  EXPECT_NEAR(1.0, std::abs(notch.response(500.0, sample_rate)), 1e-9);
+  EXPECT_NEAR(1.0, std::abs(notch.response(5.0, sample_rate)), 1e-2);
+
+  // Out of range parameters give a pass-through section
+  BiquadCoefficients bad = control_toolbox::designNotch(600.0, 10.0, 0.1, sample_rate);
+  EXPECT_EQ(1.0, bad.b0);
+  EXPECT_EQ(0.0, bad.a1);
+}
+
+TEST(NotchFilterTest, DetectResonancesTest)
+{
+  RecordProperty(
+    "description", "This test checks that the resonances of a plant with two modes are found.");
+
+  FrequencyResponse plant = twoModePlant();
+  std::vector<Resonance> resonances = control_toolbox::detectResonances(plant, 6.0, 4);
+
+  ASSERT_EQ(2u, resonances.size());
+  // Sorted by prominence, the first mode is the highest
+  EXPECT_NEAR(20.0, resonances[0].frequency, 0.2);
+  EXPECT_NEAR(60.0, resonances[1].frequency, 0.6);
+  EXPECT_GT(resonances[0].prominence, resonances[1].prominence);
+  EXPECT_GT(resonances[0].width, 0.0);
+  EXPECT_LT(resonances[0].width, 5.0);
+
+  // Limit the number of resonances
+  EXPECT_EQ(1u, control_toolbox::detectResonances(plant, 6.0, 1).size());
+}
+
+TEST(NotchFilterTest, CompensationTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the notches designed from the detected resonances flatten the plant.");
+
+  const double sample_rate = 1000.0;
+  FrequencyResponse plant = twoModePlant();
+  std::vector<BiquadCoefficients> sections =
+    control_toolbox::designNotches(control_toolbox::detectResonances(plant, 6.0, 4), sample_rate);
+  ASSERT_EQ(2u, sections.size());
+
+  FrequencyResponse compensated = plant;
+  for (size_t k = 0; k < compensated.frequencies.size(); ++k) {
+    for (const auto & section : sections) {
+      compensated.response[k] *= section.response(compensated.frequencies[k], sample_rate);
+    }
+  }
+
+  std::vector<Resonance> remaining = control_toolbox::detectResonances(compensated, 6.0, 4);
+  EXPECT_TRUE(remaining.empty());
+}
+
+TEST(NotchFilterTest, HotSwapTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the filter passes through its input until coefficients are set, and "
+    "that the coefficients can be replaced while it runs.");
+
+  const double sample_rate = 1000.0;
+  NotchFilter filter;
+  EXPECT_EQ(1.5, filter.update(1.5));
+
+  ASSERT_TRUE(filter.setCoefficients({control_toolbox::designNotch(50.0, 5.0, 0.0, sample_rate)}));
+
+  double output = 0.0;
+  double max_output = 0.0;
+  for (int k = 0; k < 4000; ++k) {
+    output = filter.update(std::sin(2.0 * M_PI * 50.0 * k / sample_rate));
+    if (k > 3000) {
+      max_output = std::max(max_output, std::abs(output));
+    }
+  }
+  EXPECT_LT(max_output, 1e-2);
+
+  // Removing all sections makes the filter pass through again
+  ASSERT_TRUE(filter.setCoefficients({}));
+  EXPECT_EQ(0.25, filter.update(0.25));
+
+  // A copy keeps the coefficients
+  ASSERT_TRUE(filter.setCoefficients({control_toolbox::designNotch(50.0, 5.0, 0.5, sample_rate)}));
+  NotchFilter copy(filter);
+  EXPECT_DOUBLE_EQ(filter.update(1.0), copy.update(1.0));
+
+  std::vector<BiquadCoefficients> too_many(NotchFilter::MAX_SECTIONS + 1);
+  EXPECT_FALSE(filter.setCoefficients(too_many));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+
+#include "control_toolbox/dither.hpp"
+#include "control_toolbox/online_trajectory_generator.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::OnlineTrajectoryGenerator;
+
+TEST(OnlineTrajectoryGeneratorTest, StaticTargetTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a static target is reached in about the time of the trapezoidal "
+    "profile, within the limits and without overshoot.");
+
+  const double v_max = 2.0, a_max = 4.0, dt = 1e-3;
+  OnlineTrajectoryGenerator generator;
+  ASSERT_TRUE(generator.init(v_max, a_max));
+  generator.reset(1.0);
+
+  double velocity, acceleration;
+  int cycles = 0;
+  for (; cycles < 10000; ++cycles) {
+    double position = generator.update(6.0, 0.0, dt, velocity, acceleration);
+    EXPECT_LE(position, 6.0 + 1e-12);
+    EXPECT_GE(velocity, -1e-9);
+    EXPECT_LE(std::abs(velocity), v_max + 1e-12);
+    EXPECT_LE(std::abs(acceleration), a_max + 1e-12);
+    if (std::abs(position - 6.0) < 1e-12 && std::abs(velocity) < 1e-9) {
+      break;
+    }
+  }
+
+  // Trapezoidal profile: d / v + v / a
+  EXPECT_NEAR(5.0 / v_max + v_max / a_max, (cycles + 1) * dt, 5 * dt);
+
+  // The target is held without chattering
+  for (int k = 0; k < 100; ++k) {
+    EXPECT_NEAR(6.0, generator.update(6.0, 0.0, dt, velocity, acceleration), 1e-12);
+    EXPECT_NEAR(0.0, velocity, 1e-9);
+  }
+}
+
+TEST(OnlineTrajectoryGeneratorTest, MovingTargetTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a target moving at constant velocity is caught up and then tracked "
+    "exactly.");
+
+  const double dt = 1e-3;
+  OnlineTrajectoryGenerator generator;
+  ASSERT_TRUE(generator.init(3.0, 10.0));
+
+  double velocity, acceleration, position = 0.0, target = 0.0;
+  for (int k = 1; k <= 3000; ++k) {
+    target = 0.5 + 1.5 * k * dt;
+    position = generator.update(target, 1.5, dt, velocity, acceleration);
+  }
+  EXPECT_NEAR(target, position, 1e-9);
+  EXPECT_NEAR(1.5, velocity, 1e-9);
+}
+
+TEST(OnlineTrajectoryGeneratorTest, JitteryTargetTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a noisy target gives a deterministic trajectory within the limits.");
+
+  control_toolbox::Dither dither;
+  ASSERT_TRUE(dither.init(0.1, 7));
+
+  OnlineTrajectoryGenerator first, second;
+  ASSERT_TRUE(first.init(1.0, 5.0));
+  ASSERT_TRUE(second.init(1.0, 5.0));
+  EXPECT_FALSE(first.init(0.0, 5.0));
+
+  const double dt = 1e-3;
+  for (int k = 0; k < 5000; ++k) {
+    const double target = std::sin(k * dt) + dither.update();
+    double v1, a1, v2, a2;
+    const double p1 = first.update(target, 0.0, dt, v1, a1);
+    const double p2 = second.update(target, 0.0, dt, v2, a2);
+    EXPECT_EQ(p1, p2);
+    EXPECT_EQ(v1, v2);
+    EXPECT_LE(std::abs(v1), 1.0 + 1e-12);
+    EXPECT_LE(std::abs(a1), 5.0 + 1e-12);
+  }
+
+  // A zero period holds the state
+  double velocity, acceleration;
+  const double position = first.getPosition();
+  EXPECT_EQ(position, first.update(10.0, 0.0, 0.0, velocity, acceleration));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
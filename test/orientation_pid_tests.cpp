@@ -0,0 +1,140 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <array>
+#include <cmath>
+
+#include "control_toolbox/orientation_pid.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::OrientationPid;
+using control_toolbox::Pid;
+using control_toolbox::PosePid;
+using control_toolbox::PosePidBatch;
+using control_toolbox::Quaternion;
+using control_toolbox::Vector3;
+
+namespace
+{
+double norm(const Vector3 & v) { return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]); }
+}  // namespace
+
+TEST(OrientationPidTest, QuaternionTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks the quaternion exponential and logarithm, and the shortest rotation.");
+
+  const Vector3 rotation = {0.3, -1.2, 0.5};
+  const Quaternion q = Quaternion::exp(rotation);
+  const Vector3 back = q.log();
+  for (size_t k = 0; k < 3; ++k) {
+    EXPECT_NEAR(rotation[k], back[k], 1e-12);
+  }
+
+  // -q is the same orientation
+  Quaternion minus_q = q;
+  minus_q.w = -q.w;
+  minus_q.x = -q.x;
+  minus_q.y = -q.y;
+  minus_q.z = -q.z;
+  EXPECT_NEAR(norm(rotation), norm(minus_q.log()), 1e-12);
+
+  // A rotation of 3/2 pi is taken as -pi/2 about the same axis
+  const Vector3 long_way = Quaternion::exp({0.0, 0.0, 1.5 * M_PI}).log();
+  EXPECT_NEAR(-0.5 * M_PI, long_way[2], 1e-12);
+
+  // Rotating x by pi/2 about z gives y
+  const Vector3 y = Quaternion::exp({0.0, 0.0, 0.5 * M_PI}).rotate({1.0, 0.0, 0.0});
+  EXPECT_NEAR(0.0, y[0], 1e-12);
+  EXPECT_NEAR(1.0, y[1], 1e-12);
+}
+
+TEST(OrientationPidTest, ConvergenceTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a kinematic orientation loop converges along the shortest rotation "
+    "from a large error.");
+
+  OrientationPid pid;
+  pid.setGains(Pid::Gains(2.0, 0.0, 0.0, 0.0, 0.0));
+
+  const Quaternion desired = Quaternion::exp({0.1, 0.2, -0.3});
+  Quaternion actual = desired * Quaternion::exp({0.0, 0.0, 0.95 * M_PI});
+  const uint64_t dt = 1000000;
+  const Vector3 zero = {0.0, 0.0, 0.0};
+  double last_angle = M_PI;
+  for (int k = 0; k < 5000; ++k) {
+    const Vector3 velocity = pid.computeCommand(desired, actual, zero, zero, dt);
+    const double angle = norm(pid.getError());
+    EXPECT_LE(angle, last_angle + 1e-12);
+    last_angle = angle;
+    actual = Quaternion::exp({velocity[0] * 1e-3, velocity[1] * 1e-3, velocity[2] * 1e-3}) * actual;
+  }
+  EXPECT_LT(last_angle, 1e-3);
+}
+
+TEST(OrientationPidTest, PoseTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks the wrench of the pose pid and the batch of end effectors.");
+
+  PosePidBatch<2> batch;
+  batch[0].setGains(Pid::Gains(10.0, 0.0, 1.0, 0.0, 0.0), Pid::Gains(5.0, 0.0, 0.5, 0.0, 0.0));
+  batch[1].setGains(Pid::Gains(1.0, 0.0, 0.0, 0.0, 0.0), Pid::Gains(2.0, 0.0, 0.0, 0.0, 0.0));
+
+  PosePidBatch<2>::Poses desired, actual;
+  PosePidBatch<2>::Twists desired_twists, actual_twists;
+  desired[0].position = {1.0, 0.0, 0.0};
+  desired[0].orientation = Quaternion::exp({0.0, 0.2, 0.0});
+  actual_twists[0].linear = {0.5, 0.0, 0.0};
+  actual_twists[0].angular = {0.0, 0.0, 1.0};
+  desired[1].position = {0.0, 0.0, -2.0};
+
+  PosePidBatch<2>::Wrenches wrenches;
+  batch.computeCommands(desired, actual, desired_twists, actual_twists, 1000000, wrenches);
+
+  EXPECT_NEAR(10.0 * 1.0 - 1.0 * 0.5, wrenches[0][0], 1e-12);
+  EXPECT_NEAR(5.0 * 0.2, wrenches[0][4], 1e-12);
+  EXPECT_NEAR(-0.5 * 1.0, wrenches[0][5], 1e-12);
+  EXPECT_NEAR(-2.0, wrenches[1][2], 1e-12);
+  EXPECT_NEAR(0.0, wrenches[1][3], 1e-12);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <vector>
+
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/pid_bank.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::Pid;
+using control_toolbox::PidBank;
+
+TEST(PidBankTest, MatchesPidTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a bank evaluated every cycle gives the same commands as separate Pid "
+    "instances.");
+
+  const std::vector<Pid::Gains> gains = {
+    Pid::Gains(1.0, 2.0, 0.1, 0.5, -0.5, false), Pid::Gains(3.0, 1.0, 0.0, 2.0, -1.0, true),
+    Pid::Gains(0.5, 0.0, 0.2, 0.0, 0.0, false)};
+
+  PidBank bank;
+  ASSERT_TRUE(bank.init(gains.size(), Pid::Gains()));
+  ASSERT_TRUE(bank.setGains(gains));
+  std::vector<Pid> pids;
+  for (const auto & g : gains) {
+    pids.emplace_back(g.p_gain_, g.i_gain_, g.d_gain_, g.i_max_, g.i_min_, g.antiwindup_);
+  }
+
+  const uint64_t dt = 1000000;
+  std::vector<double> errors(gains.size()), commands;
+  for (int k = 0; k < 1000; ++k) {
+    for (size_t c = 0; c < gains.size(); ++c) {
+      errors[c] = std::sin(0.01 * k * (c + 1)) + 0.2 * c;
+    }
+    ASSERT_TRUE(bank.computeCommands(errors, dt, commands));
+    EXPECT_EQ(gains.size(), bank.getActiveChannels().size());
+    for (size_t c = 0; c < gains.size(); ++c) {
+      EXPECT_NEAR(pids[c].computeCommand(errors[c], dt), commands[c], 1e-9);
+    }
+  }
+  EXPECT_EQ(0.0, bank.getSkipRatio());
+
+  EXPECT_FALSE(bank.computeCommands({1.0}, dt, commands));
+  EXPECT_FALSE(bank.computeCommands(errors, 0, commands));
+  EXPECT_FALSE(bank.setGains({Pid::Gains()}));
+}
+
+TEST(PidBankTest, EventTriggerTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that channels with a steady error are skipped, and that the integral "
+    "covers the skipped cycles on the next evaluation.");
+
+  PidBank bank;
+  ASSERT_TRUE(bank.init(2, Pid::Gains(1.0, 1.0, 0.0, 100.0, -100.0)));
+  const uint64_t dt = 1000000;
+  ASSERT_TRUE(bank.setEventTrigger(0.01, 100 * dt));
+  EXPECT_FALSE(bank.setEventTrigger(-1.0, 0));
+
+  std::vector<double> commands;
+  ASSERT_TRUE(bank.computeCommands({0.5, 0.5}, dt, commands));
+  EXPECT_EQ(2u, bank.getActiveChannels().size());
+  const double held = commands[0];
+
+  // The second channel moves, the first one is held until the maximum interval elapses
+  for (int k = 1; k < 100; ++k) {
+    ASSERT_TRUE(bank.computeCommands({0.5, 0.5 + 0.02 * k}, dt, commands));
+    ASSERT_EQ(1u, bank.getActiveChannels().size());
+    EXPECT_EQ(1u, bank.getActiveChannels()[0]);
+    EXPECT_EQ(held, commands[0]);
+  }
+  ASSERT_TRUE(bank.computeCommands({0.5, 2.5}, dt, commands));
+  EXPECT_EQ(2u, bank.getActiveChannels().size());
+
+  // 101 cycles of 1 ms at an error of 0.5
+  double pe, ie, de;
+  bank.getCurrentPIDErrors(0, pe, ie, de);
+  EXPECT_NEAR(0.101 * 0.5, ie, 1e-12);
+  EXPECT_NEAR(0.5 + 0.101 * 0.5, commands[0], 1e-12);
+  EXPECT_NEAR(99.0 / 202.0, bank.getSkipRatio(), 1e-12);
+
+  // A step beyond the threshold triggers at once
+  ASSERT_TRUE(bank.computeCommands({0.6, 2.5}, dt, commands));
+  ASSERT_EQ(1u, bank.getActiveChannels().size());
+  EXPECT_EQ(0u, bank.getActiveChannels()[0]);
+
+  bank.reset();
+  EXPECT_EQ(0.0, bank.getSkipRatio());
+}
+
+TEST(PidBankTest, RateDividersTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that channels with rate dividers are spread evenly over the cycles and "
+    "behave as a Pid running at their own rate.");
+
+  const std::vector<unsigned int> dividers = {1, 4, 4, 4, 4, 2, 2};
+  PidBank bank;
+  ASSERT_TRUE(bank.init(dividers.size(), Pid::Gains(2.0, 1.0, 0.05, 10.0, -10.0)));
+  EXPECT_FALSE(bank.setRateDividers({1, 2}));
+  EXPECT_FALSE(bank.setRateDividers({1, 0, 1, 1, 1, 1, 1}));
+  ASSERT_TRUE(bank.setRateDividers(dividers));
+
+  // 12 evaluations every 4 cycles
+  EXPECT_EQ(3u, bank.getMaxSlotLoad());
+
+  std::vector<Pid> pids(dividers.size(), Pid(2.0, 1.0, 0.05, 10.0, -10.0));
+  std::vector<int> evaluations(dividers.size(), 0);
+  const uint64_t dt = 250000;
+  std::vector<double> errors(dividers.size()), commands;
+  for (int k = 0; k < 400; ++k) {
+    for (size_t c = 0; c < dividers.size(); ++c) {
+      errors[c] = std::cos(0.02 * k + c);
+    }
+    ASSERT_TRUE(bank.computeCommands(errors, dt, commands));
+    EXPECT_EQ(3u, bank.getActiveChannels().size());
+    for (const size_t c : bank.getActiveChannels()) {
+      // The first evaluation covers the cycles since the start
+      const uint64_t pid_dt = evaluations[c] == 0 ? (k + 1) * dt : dividers[c] * dt;
+      EXPECT_NEAR(pids[c].computeCommand(errors[c], pid_dt), commands[c], 1e-9);
+      ++evaluations[c];
+    }
+  }
+  for (size_t c = 0; c < dividers.size(); ++c) {
+    EXPECT_EQ(400 / static_cast<int>(dividers[c]), evaluations[c]);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
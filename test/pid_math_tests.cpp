@@ -0,0 +1,191 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "control_toolbox/pid.hpp"
+#include "control_toolbox/pid_bank.hpp"
+#include "control_toolbox/pid_math.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::Pid;
+using control_toolbox::PidBank;
+namespace pid_math = control_toolbox::pid_math;
+
+namespace
+{
+// A single update from a zero integral. The values are exact in binary floating point, so the
+// expected results are exact too.
+struct ReferenceVector
+{
+  Pid::Gains gains;
+  double error;
+  double error_dot;
+  uint64_t dt;
+  double i_error; /**< Expected integral after the update. */
+  double command; /**< Expected command. */
+};
+
+constexpr std::array<ReferenceVector, 7> REFERENCE_VECTORS = {{
+  // Proportional only, the integral accumulates but its term is clamped to 0
+  {Pid::Gains(2.0, 0.0, 0.0, 0.0, 0.0), 1.5, 0.0, 1000000000, 1.5, 3.0},
+  // Integral within its limits
+  {Pid::Gains(1.0, 4.0, 0.0, 1.0, -1.0), 0.25, 0.0, 500000000, 0.125, 0.75},
+  // Integral term clamped, the integral itself is not
+  {Pid::Gains(1.0, 4.0, 0.0, 1.0, -1.0), 1.0, 0.0, 500000000, 0.5, 2.0},
+  // Antiwindup limits the integral instead
+  {Pid::Gains(1.0, 4.0, 0.0, 1.0, -1.0, true), 1.0, 0.0, 500000000, 0.25, 2.0},
+  // Antiwindup with a negative integral gain swaps the bounds
+  {Pid::Gains(0.0, -2.0, 0.0, 1.0, -1.0, true), 1.0, 0.0, 1000000000, 0.5, -1.0},
+  // Antiwindup ignored with a zero integral gain
+  {Pid::Gains(1.0, 0.0, 0.0, 1.0, -1.0, true), 4.0, 0.0, 1000000000, 4.0, 4.0},
+  // Derivative
+  {Pid::Gains(1.0, 0.0, 0.5, 0.0, 0.0), -1.0, 4.0, 250000000, -0.25, 1.0},
+}};
+
+constexpr bool matches(const ReferenceVector & v)
+{
+  const pid_math::Step step = pid_math::computeStep(v.gains, 0.0, v.error, v.error_dot, v.dt);
+  return step.i_error == v.i_error && step.command == v.command;
+}
+
+constexpr bool matchesAll()
+{
+  for (const auto & v : REFERENCE_VECTORS) {
+    if (!matches(v)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Commands of a Pid fed with errors, the derivative taken from consecutive errors
+template <std::size_t N>
+constexpr std::array<double, N> referenceSequence(
+  const Pid::Gains & gains, const std::array<double, N> & errors, uint64_t dt)
+{
+  std::array<double, N> commands{};
+  double i_error = 0.0;
+  double last_error = 0.0;
+  for (std::size_t k = 0; k < N; ++k) {
+    const double error_dot = pid_math::differentiate(errors[k], last_error, dt);
+    const pid_math::Step step = pid_math::computeStep(gains, i_error, errors[k], error_dot, dt);
+    i_error = step.i_error;
+    last_error = errors[k];
+    commands[k] = step.command;
+  }
+  return commands;
+}
+
+constexpr std::array<double, 6> SEQUENCE_ERRORS = {1.0, 0.5, 0.25, -0.5, -1.0, 0.0};
+constexpr uint64_t SEQUENCE_DT = 500000000;
+}  // namespace
+
+// Checked when compiling
+static_assert(pid_math::clamp(2.0, -1.0, 1.0) == 1.0, "clamp above");
+static_assert(pid_math::clamp(-2.0, -1.0, 1.0) == -1.0, "clamp below");
+static_assert(pid_math::clamp(0.5, -1.0, 1.0) == 0.5, "clamp within");
+static_assert(pid_math::integrate(1.0, 2.0, 250000000) == 1.5, "integrate");
+static_assert(pid_math::differentiate(1.0, 0.5, 250000000) == 2.0, "differentiate");
+static_assert(matchesAll(), "reference vectors");
+static_assert(
+  referenceSequence(Pid::Gains(1.0, 2.0, 0.5, 1.0, -1.0), SEQUENCE_ERRORS, SEQUENCE_DT)[1] ==
+    // p: 0.5, i: 2 * (0.5 + 0.25) = 1.5 clamped to 1, d: 0.5 * (0.5 - 1) / 0.5 = -0.5
+    1.0,
+  "sequence");
+
+TEST(PidMathTest, PidMatchesReferenceTest)
+{
+  RecordProperty(
+    "description", "This test checks Pid::computeCommand against the reference vectors.");
+
+  for (const auto & v : REFERENCE_VECTORS) {
+    Pid pid;
+    pid.setGains(v.gains);
+    EXPECT_EQ(v.command, pid.computeCommand(v.error, v.error_dot, v.dt));
+    double pe, ie, de;
+    pid.getCurrentPIDErrors(pe, ie, de);
+    EXPECT_EQ(v.i_error, ie);
+  }
+}
+
+TEST(PidMathTest, PidSequenceTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks a Pid differentiating its error against the constexpr reference.");
+
+  for (const auto & v : REFERENCE_VECTORS) {
+    const auto expected = referenceSequence(v.gains, SEQUENCE_ERRORS, SEQUENCE_DT);
+    Pid pid;
+    pid.setGains(v.gains);
+    for (std::size_t k = 0; k < SEQUENCE_ERRORS.size(); ++k) {
+      EXPECT_EQ(expected[k], pid.computeCommand(SEQUENCE_ERRORS[k], SEQUENCE_DT));
+    }
+  }
+}
+
+TEST(PidMathTest, PidBankSequenceTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks every channel of a PidBank, one per reference gain set, against the "
+    "constexpr reference.");
+
+  std::vector<Pid::Gains> gains;
+  for (const auto & v : REFERENCE_VECTORS) {
+    gains.push_back(v.gains);
+  }
+  PidBank bank;
+  ASSERT_TRUE(bank.init(gains.size(), Pid::Gains()));
+  ASSERT_TRUE(bank.setGains(gains));
+
+  std::vector<double> errors(gains.size()), commands;
+  for (std::size_t k = 0; k < SEQUENCE_ERRORS.size(); ++k) {
+    std::fill(errors.begin(), errors.end(), SEQUENCE_ERRORS[k]);
+    ASSERT_TRUE(bank.computeCommands(errors, SEQUENCE_DT, commands));
+    for (std::size_t c = 0; c < gains.size(); ++c) {
+      const auto expected = referenceSequence(gains[c], SEQUENCE_ERRORS, SEQUENCE_DT);
+      EXPECT_DOUBLE_EQ(expected[k], commands[c]) << "channel " << c << ", cycle " << k;
+    }
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
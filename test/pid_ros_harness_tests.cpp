@@ -0,0 +1,137 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "control_toolbox/pid.hpp"
+
+#include "gtest/gtest.h"
+
+#include "pid_ros_test_harness.hpp"
+
+using control_toolbox::PidROSTestHarness;
+
+TEST(PidROSHarnessTest, SimulatedTimeTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the captured states are stamped with the simulated time and match "
+    "the commands of a plain Pid.");
+
+  PidROSTestHarness harness;
+  harness.pid().initPid(1.0, 2.0, 0.1, 5.0, -5.0, false);
+  control_toolbox::Pid pid(1.0, 2.0, 0.1, 5.0, -5.0, false);
+
+  const size_t cycles = 10000;
+  const rclcpp::Duration dt(0, 1000000);
+  harness.reserveStates(cycles);
+  for (size_t k = 0; k < cycles; ++k) {
+    const double error = 0.5 - 1e-4 * k;
+    EXPECT_EQ(pid.computeCommand(error, dt.nanoseconds()), harness.step(error, dt));
+  }
+
+  const auto & states = harness.states();
+  ASSERT_EQ(cycles, states.size());
+  for (size_t k = 0; k < cycles; k += 997) {
+    const rclcpp::Time stamp(states[k].header.stamp);
+    EXPECT_EQ(static_cast<int64_t>((k + 1) * 1000000), stamp.nanoseconds());
+    EXPECT_DOUBLE_EQ(0.5 - 1e-4 * k, states[k].error);
+    EXPECT_EQ(1000000u, states[k].timestep.nanosec);
+  }
+  EXPECT_EQ(10.0, harness.now().seconds());
+}
+
+TEST(PidROSHarnessTest, ParameterUpdateTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a parameter update is applied at the next simulated cycle.");
+
+  PidROSTestHarness harness("joint1");
+  harness.pid().initPid(1.0, 0.0, 0.0, 0.0, 0.0, false);
+
+  const rclcpp::Duration dt(0, 1000000);
+  EXPECT_EQ(1.0, harness.step(1.0, 0.0, dt));
+  ASSERT_TRUE(harness.node()->set_parameter(rclcpp::Parameter("joint1.p", 3.0)).successful);
+  EXPECT_EQ(3.0, harness.step(1.0, 0.0, dt));
+
+  ASSERT_EQ(2u, harness.states().size());
+  EXPECT_EQ(1.0, harness.states()[0].p_term);
+  EXPECT_EQ(3.0, harness.states()[1].p_term);
+}
+
+TEST(PidROSHarnessTest, ThroughputTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that simulated cycles run without waiting for the wall clock, at well "
+    "over a thousand cycles per millisecond.");
+
+  PidROSTestHarness harness;
+  harness.pid().initPid(1.0, 1.0, 0.0, 1.0, -1.0, false);
+
+  // Ten simulated minutes at 1 kHz, which would take that long if anything waited on real time
+  const size_t cycles = 600000;
+  const rclcpp::Duration dt(0, 1000000);
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t k = 0; k < cycles; ++k) {
+    harness.step(0.1, dt);
+    if (k % 10000 == 0) {
+      harness.clearStates();
+    }
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+    std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(600.0, harness.now().seconds());
+
+  // Thousands of cycles per millisecond is below a microsecond per cycle, the bound leaves room
+  // for loaded machines and debug builds but catches anything waiting on the wall clock
+#if defined(__SANITIZE_THREAD__)
+  const double max_ns_per_cycle = 100000.0;
+#else
+  const double max_ns_per_cycle = 10000.0;
+#endif
+  const double ns_per_cycle = elapsed.count() / cycles;
+  RecordProperty("ns_per_cycle", std::to_string(ns_per_cycle));
+  EXPECT_LT(ns_per_cycle, max_ns_per_cycle);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  rclcpp::init(0, nullptr);
+  const int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
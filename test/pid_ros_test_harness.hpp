@@ -0,0 +1,158 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CONTROL_TOOLBOX__PID_ROS_TEST_HARNESS_HPP_
+#define CONTROL_TOOLBOX__PID_ROS_TEST_HARNESS_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "control_msgs/msg/pid_state.hpp"
+
+#include "rcl/time.h"
+#include "rclcpp/rclcpp.hpp"
+
+#include "control_toolbox/pid_ros.hpp"
+
+namespace control_toolbox
+{
+/***************************************************/
+/*! \class PidROSTestHarness
+    \brief Drives a PidROS with simulated time, deterministically
+
+    The PidROS lives on its own node, without parameter services, and
+    stamps its states with a ROS clock whose time is overridden. Every
+    step advances the simulated time by the time step and calls
+    computeCommand. The states are captured in-process through the state
+    callback instead of being published, so a cycle costs no more than the
+    computation and nothing depends on the wall clock or on other threads.
+    Callbacks of the node, e.g. of subscriptions created by the test, run
+    in a single threaded executor when spinSome() is called.
+
+    rclcpp must be initialized before a harness is created.
+*/
+/***************************************************/
+
+class PidROSTestHarness
+{
+public:
+  /*!
+   * \param prefix Prefix of the PidROS parameters and topics.
+   * \param node_name Name of the node holding the PidROS.
+   */
+  explicit PidROSTestHarness(
+    const std::string & prefix = "", const std::string & node_name = "pid_ros_test_harness")
+  : node_(std::make_shared<rclcpp::Node>(
+      node_name,
+      rclcpp::NodeOptions().start_parameter_services(false).start_parameter_event_publisher(
+        false))),
+    clock_(std::make_shared<rclcpp::Clock>(RCL_ROS_TIME)),
+    time_(0)
+  {
+    rcl_enable_ros_time_override(clock_->get_clock_handle());
+    rcl_set_ros_time_override(clock_->get_clock_handle(), time_);
+
+    pid_ = std::make_unique<PidROS>(node_, prefix);
+    pid_->setClock(clock_);
+    pid_->setStateCallback(
+      [this](const control_msgs::msg::PidState & state) { states_.push_back(state); });
+    executor_.add_node(node_);
+  }
+
+  ~PidROSTestHarness() { executor_.remove_node(node_); }
+
+  /*!
+   * \brief Advances the simulated time by \c dt and computes the command
+   */
+  double step(double error, const rclcpp::Duration & dt)
+  {
+    advance(dt);
+    return pid_->computeCommand(error, dt);
+  }
+
+  /*!
+   * \brief Advances the simulated time by \c dt and computes the command with \c error_dot
+   */
+  double step(double error, double error_dot, const rclcpp::Duration & dt)
+  {
+    advance(dt);
+    return pid_->computeCommand(error, error_dot, dt);
+  }
+
+  /*!
+   * \brief Advances the simulated time without computing a command
+   */
+  void advance(const rclcpp::Duration & dt)
+  {
+    time_ += dt.nanoseconds();
+    rcl_set_ros_time_override(clock_->get_clock_handle(), time_);
+  }
+
+  /*!
+   * \brief Executes the callbacks of the node that are ready, in this thread
+   */
+  void spinSome() { executor_.spin_some(); }
+
+  /*!
+   * \brief Return the simulated time
+   */
+  rclcpp::Time now() const { return rclcpp::Time(time_, RCL_ROS_TIME); }
+
+  PidROS & pid() { return *pid_; }
+
+  rclcpp::Node::SharedPtr node() { return node_; }
+
+  /*!
+   * \brief Return the states captured since the start or the last clearStates()
+   */
+  const std::vector<control_msgs::msg::PidState> & states() const { return states_; }
+
+  void clearStates() { states_.clear(); }
+
+  /*!
+   * \brief Reserve room for \c cycles states, so capturing them does not allocate
+   */
+  void reserveStates(std::size_t cycles) { states_.reserve(cycles); }
+
+private:
+  rclcpp::Node::SharedPtr node_;
+  rclcpp::Clock::SharedPtr clock_;
+  rcl_time_point_value_t time_; /**< Simulated time in nanoseconds. */
+  rclcpp::executors::SingleThreadedExecutor executor_;
+  std::unique_ptr<PidROS> pid_;
+  std::vector<control_msgs::msg::PidState> states_;
+};
+
+}  // namespace control_toolbox
+
+#endif  // CONTROL_TOOLBOX__PID_ROS_TEST_HARNESS_HPP_
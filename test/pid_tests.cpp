@@ -405,6 +405,43 @@ TEST(CommandTest, completePIDTest)
   EXPECT_EQ(-3.5, cmd);
 }
 
+TEST(CommandTest, gainRampTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that new gains are reached linearly over the configured number of cycles, "
+    "and that the integral term stays continuous while the integral gain changes.");
+
+  Pid pid(1.0, 2.0, 0.0, 100.0, -100.0);
+  pid.setGainRampCycles(4);
+  EXPECT_EQ(4u, pid.getGainRampCycles());
+
+  // Build up an integral term of 2 * 1.0 = 2.0 with the initial gains
+  double cmd = pid.computeCommand(1.0, 1.0 * 1e9);
+  EXPECT_EQ(3.0, cmd);
+
+  // With a null error only the integral term remains, the ramp keeps it at 2.0
+  pid.setGains(5.0, 4.0, 0.0, 100.0, -100.0);
+  for (int k = 1; k <= 4; ++k) {
+    cmd = pid.computeCommand(0.0, 1.0 * 1e9);
+    EXPECT_NEAR(2.0, cmd, 1e-12);
+    EXPECT_DOUBLE_EQ(1.0 + k, pid.getActiveGains().p_gain_);
+    EXPECT_DOUBLE_EQ(2.0 + 0.5 * k, pid.getActiveGains().i_gain_);
+  }
+  EXPECT_EQ(5.0, pid.getActiveGains().p_gain_);
+  EXPECT_EQ(4.0, pid.getActiveGains().i_gain_);
+
+  // The ramp is done, the proportional term uses the new gain
+  cmd = pid.computeCommand(1.0, 1.0 * 1e9);
+  EXPECT_NEAR(5.0 + 2.0 + 4.0, cmd, 1e-12);
+
+  // Without a ramp, gains are applied at once
+  pid.setGainRampCycles(0);
+  pid.setGains(1.0, 0.0, 0.0, 0.0, 0.0);
+  cmd = pid.computeCommand(1.0, 1.0 * 1e9);
+  EXPECT_EQ(1.0, cmd);
+}
+
 int main(int argc, char ** argv)
 {
   testing::InitGoogleTest(&argc, argv);
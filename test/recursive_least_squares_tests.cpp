@@ -0,0 +1,220 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <array>
+#include <cmath>
+
+#include "control_toolbox/dither.hpp"
+#include "control_toolbox/recursive_least_squares.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::ArxEstimator;
+using control_toolbox::RecursiveLeastSquares;
+using control_toolbox::RecursiveLeastSquaresBank;
+
+TEST(RecursiveLeastSquaresTest, ArxIdentificationTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the coefficients of a second order ARX plant excited with white noise "
+    "are identified.");
+
+  control_toolbox::Dither excitation;
+  ASSERT_TRUE(excitation.init(1.0, 11));
+
+  // y(k) = 1.5 y(k-1) - 0.7 y(k-2) + 0.5 u(k-1) + 0.25 u(k-2)
+  ArxEstimator<2, 2> arx;
+  ASSERT_TRUE(arx.init(1.0, 1e4));
+  double y1 = 0.0, y2 = 0.0, u1 = 0.0, u2 = 0.0;
+  for (int k = 0; k < 500; ++k) {
+    double y = 1.5 * y1 - 0.7 * y2 + 0.5 * u1 + 0.25 * u2;
+    arx.update(u1, y);
+    y2 = y1;
+    y1 = y;
+    u2 = u1;
+    u1 = excitation.update();
+  }
+
+  EXPECT_NEAR(-1.5, arx.getA(1), 1e-6);
+  EXPECT_NEAR(0.7, arx.getA(2), 1e-6);
+  EXPECT_NEAR(0.5, arx.getB(1), 1e-6);
+  EXPECT_NEAR(0.25, arx.getB(2), 1e-6);
+}
+
+TEST(RecursiveLeastSquaresTest, ForgettingTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a forgetting factor lets the estimate follow a change of the "
+    "parameters, and that the covariance is reset when its trace leaves its bounds.");
+
+  control_toolbox::Dither excitation;
+  ASSERT_TRUE(excitation.init(1.0, 12));
+
+  RecursiveLeastSquares<2> rls;
+  EXPECT_FALSE(rls.init(0.0, 1.0));
+  EXPECT_FALSE(rls.init(0.98, -1.0));
+  ASSERT_TRUE(rls.init(0.98, 100.0, 1e-3, 1e3));
+
+  double gain = 2.0;
+  for (int k = 0; k < 2000; ++k) {
+    if (k == 1000) {
+      gain = -1.0;
+    }
+    RecursiveLeastSquares<2>::Vector phi = {excitation.update(), 1.0};
+    rls.update(phi, gain * phi[0] + 0.5);
+    if (k == 999) {
+      EXPECT_NEAR(2.0, rls.getParameters()[0], 1e-6);
+    }
+  }
+  EXPECT_NEAR(-1.0, rls.getParameters()[0], 1e-6);
+  EXPECT_NEAR(0.5, rls.getParameters()[1], 1e-6);
+  EXPECT_NEAR(0.5, rls.predict({0.0, 1.0}), 1e-6);
+
+  // Without excitation the covariance winds up until it is reset
+  EXPECT_EQ(0u, rls.getNumResets());
+  for (int k = 0; k < 1000; ++k) {
+    rls.update({0.0, 0.0}, 0.0);
+  }
+  EXPECT_GT(rls.getNumResets(), 0u);
+  const auto & covariance = rls.getCovariance();
+  EXPECT_LE(covariance[0] + covariance[3], 1e3);
+}
+
+TEST(RecursiveLeastSquaresTest, BankTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that each channel of a bank gives the same estimate as a single "
+    "estimator.");
+
+  constexpr size_t N = 3;
+  constexpr size_t C = 4;
+  control_toolbox::Dither excitation;
+  ASSERT_TRUE(excitation.init(1.0, 13));
+
+  RecursiveLeastSquaresBank<N, C> bank;
+  std::array<RecursiveLeastSquares<N>, C> singles;
+  ASSERT_TRUE(bank.init(0.995, 50.0));
+  for (auto & single : singles) {
+    ASSERT_TRUE(single.init(0.995, 50.0));
+  }
+
+  for (int k = 0; k < 300; ++k) {
+    RecursiveLeastSquaresBank<N, C>::Regressors regressors;
+    RecursiveLeastSquaresBank<N, C>::ChannelVector measurements, errors;
+    for (size_t c = 0; c < C; ++c) {
+      RecursiveLeastSquares<N>::Vector phi;
+      for (size_t i = 0; i < N; ++i) {
+        phi[i] = excitation.update();
+        regressors[i][c] = phi[i];
+      }
+      measurements[c] = (c + 1.0) * phi[0] - phi[1] + 0.1 * c * phi[2];
+      singles[c].update(phi, measurements[c]);
+    }
+    bank.update(regressors, measurements, errors);
+  }
+
+  for (size_t c = 0; c < C; ++c) {
+    for (size_t i = 0; i < N; ++i) {
+      EXPECT_NEAR(singles[c].getParameters()[i], bank.getParameter(c, i), 1e-9);
+    }
+    EXPECT_NEAR(c + 1.0, bank.getParameter(c, 0), 1e-3);
+  }
+}
+
+TEST(RecursiveLeastSquaresTest, BankInvalidDataTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a bank channel fed regressors that are not finite keeps its estimate "
+    "and covariance, and that the other channels are unaffected.");
+
+  constexpr size_t N = 2;
+  constexpr size_t C = 3;
+  control_toolbox::Dither excitation;
+  ASSERT_TRUE(excitation.init(1.0, 17));
+
+  RecursiveLeastSquaresBank<N, C> bank;
+  std::array<RecursiveLeastSquares<N>, C> singles;
+  ASSERT_TRUE(bank.init(0.99, 50.0));
+  for (auto & single : singles) {
+    ASSERT_TRUE(single.init(0.99, 50.0));
+  }
+
+  std::array<double, N> held;
+  for (int k = 0; k < 400; ++k) {
+    RecursiveLeastSquaresBank<N, C>::Regressors regressors;
+    RecursiveLeastSquaresBank<N, C>::ChannelVector measurements, errors;
+    for (size_t c = 0; c < C; ++c) {
+      RecursiveLeastSquares<N>::Vector phi;
+      for (size_t i = 0; i < N; ++i) {
+        phi[i] = excitation.update();
+      }
+      measurements[c] = (c + 1.0) * phi[0] + 2.0 * phi[1];
+      // Channel 1 gets invalid regressors for a while
+      if (c == 1 && k >= 100 && k < 200) {
+        phi[k % N] = (k % 3 == 0) ? std::nan("") : (k % 3 == 1 ? INFINITY : -INFINITY);
+      }
+      for (size_t i = 0; i < N; ++i) {
+        regressors[i][c] = phi[i];
+      }
+      singles[c].update(phi, measurements[c]);
+    }
+    if (k == 100) {
+      for (size_t i = 0; i < N; ++i) {
+        held[i] = bank.getParameter(1, i);
+      }
+    }
+    bank.update(regressors, measurements, errors);
+    if (k >= 100 && k < 200) {
+      EXPECT_EQ(0.0, errors[1]);
+      for (size_t i = 0; i < N; ++i) {
+        ASSERT_EQ(held[i], bank.getParameter(1, i));
+      }
+    }
+  }
+
+  for (size_t c = 0; c < C; ++c) {
+    for (size_t i = 0; i < N; ++i) {
+      EXPECT_NEAR(singles[c].getParameters()[i], bank.getParameter(c, i), 1e-9);
+    }
+    EXPECT_NEAR(c + 1.0, bank.getParameter(c, 0), 1e-3);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
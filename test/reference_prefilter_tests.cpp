@@ -0,0 +1,135 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "control_toolbox/reference_prefilter.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::ReferencePrefilter;
+
+TEST(ReferencePrefilterTest, CriticallyDampedTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that the critically damped prefilter follows a step without overshoot "
+    "and with the rise time of its continuous counterpart.");
+
+  const double sample_rate = 1000.0, bandwidth = 5.0;
+  ReferencePrefilter prefilter;
+  ASSERT_TRUE(prefilter.initCriticallyDamped(1, bandwidth, sample_rate));
+
+  // Continuous step response 1 - (1 + w t) exp(-w t)
+  const double w = 2.0 * M_PI * bandwidth;
+  double last = 0.0;
+  for (int k = 0; k < 1000; ++k) {
+    const double y = prefilter.update(0, 1.0);
+    const double t = (k + 0.5) / sample_rate;
+    EXPECT_NEAR(1.0 - (1.0 + w * t) * std::exp(-w * t), y, 2e-3);
+    EXPECT_LE(y, 1.0 + 1e-12);
+    EXPECT_GE(y, last);
+    last = y;
+  }
+  EXPECT_NEAR(1.0, last, 1e-6);
+
+  // The prewarping keeps the -6 dB point of the double pole at the bandwidth
+  std::complex<double> response = prefilter.getCoefficients().response(bandwidth, sample_rate);
+  EXPECT_NEAR(0.5, std::abs(response), 1e-9);
+
+  EXPECT_FALSE(prefilter.initCriticallyDamped(1, 600.0, sample_rate));
+  EXPECT_FALSE(prefilter.initCriticallyDamped(0, bandwidth, sample_rate));
+}
+
+TEST(ReferencePrefilterTest, ModelMatchingTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a model matching prefilter reproduces its model, and that unstable "
+    "models are rejected.");
+
+  const double sample_rate = 1000.0;
+  ReferencePrefilter prefilter;
+
+  // Identity model
+  ASSERT_TRUE(prefilter.initModelMatching(1, {1.0, 0.3, 0.01}, {1.0, 0.3, 0.01}, sample_rate));
+  EXPECT_NEAR(2.5, prefilter.update(0, 2.5), 1e-12);
+
+  // Underdamped model with 10 % overshoot
+  const double zeta = 0.59, w = 20.0;
+  ASSERT_TRUE(
+    prefilter.initModelMatching(1, {w * w, 0.0, 0.0}, {w * w, 2.0 * zeta * w, 1.0}, sample_rate));
+  double peak = 0.0;
+  for (int k = 0; k < 2000; ++k) {
+    peak = std::max(peak, prefilter.update(0, 1.0));
+  }
+  EXPECT_NEAR(1.1, peak, 5e-3);
+
+  EXPECT_FALSE(prefilter.initModelMatching(1, {1.0, 0.0, 0.0}, {-1.0, 1.0, 0.0}, sample_rate));
+}
+
+TEST(ReferencePrefilterTest, ChannelsTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that channels are filtered independently, start at rest after reset and "
+    "reject a wrong number of references.");
+
+  ReferencePrefilter prefilter, single;
+  ASSERT_TRUE(prefilter.initCriticallyDamped(3, 10.0, 500.0));
+  ASSERT_TRUE(single.initCriticallyDamped(1, 10.0, 500.0));
+  ASSERT_EQ(3u, prefilter.size());
+
+  prefilter.reset({0.0, 1.0, -2.0});
+  std::vector<double> filtered;
+  for (int k = 0; k < 100; ++k) {
+    const double reference = std::sin(0.1 * k);
+    ASSERT_TRUE(prefilter.update({reference, 1.0, -2.0}, filtered));
+    ASSERT_EQ(3u, filtered.size());
+    EXPECT_DOUBLE_EQ(single.update(0, reference), filtered[0]);
+    EXPECT_NEAR(1.0, filtered[1], 1e-12);
+    EXPECT_NEAR(-2.0, filtered[2], 1e-12);
+  }
+
+  const std::vector<double> last = filtered;
+  EXPECT_FALSE(prefilter.update({1.0, 1.0}, filtered));
+  EXPECT_EQ(last, filtered);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,165 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cmath>
+#include <vector>
+
+#include "control_toolbox/s_curve_trajectory.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::SCurveTrajectory;
+using control_toolbox::SynchronizedSCurveTrajectory;
+
+namespace
+{
+// Samples a trajectory and checks its limits and the continuity of its derivatives
+void checkTrajectory(
+  const SCurveTrajectory & trajectory, double v_max, double a_max, double j_max)
+{
+  const double dt = 1e-4;
+  double qd_last = 0.0, qdd_last = 0.0;
+  double q_last = trajectory.update(0.0, qd_last, qdd_last);
+  for (double t = dt; t < trajectory.getDuration() + 10 * dt; t += dt) {
+    double qd, qdd;
+    double q = trajectory.update(t, qd, qdd);
+    EXPECT_LE(std::abs(qd), v_max + 1e-9);
+    EXPECT_LE(std::abs(qdd), a_max + 1e-9);
+    EXPECT_LE(std::abs(qdd - qdd_last), j_max * dt + 1e-9);
+    EXPECT_NEAR(qd_last + 0.5 * (qdd + qdd_last) * dt, qd, j_max * dt * dt);
+    EXPECT_NEAR(q_last + 0.5 * (qd + qd_last) * dt, q, a_max * dt * dt);
+    q_last = q;
+    qd_last = qd;
+    qdd_last = qdd;
+  }
+}
+}  // namespace
+
+TEST(SCurveTrajectoryTest, FullProfileTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks the duration of a profile reaching all limits and that they are respected.");
+
+  SCurveTrajectory trajectory;
+  ASSERT_TRUE(trajectory.init(1.0, 11.0, 2.0, 1.0, 1.0));
+
+  // 1 s jerk, 1 s constant acceleration, 1 s jerk, 2 s cruise and the mirrored deceleration
+  EXPECT_NEAR(8.0, trajectory.getDuration(), 1e-12);
+  checkTrajectory(trajectory, 2.0, 1.0, 1.0);
+
+  double qd, qdd;
+  EXPECT_DOUBLE_EQ(1.0, trajectory.update(-1.0, qd, qdd));
+  EXPECT_NEAR(6.0, trajectory.update(4.0, qd, qdd), 1e-12);
+  EXPECT_NEAR(2.0, qd, 1e-12);
+  EXPECT_DOUBLE_EQ(11.0, trajectory.update(8.0, qd, qdd));
+  EXPECT_EQ(0.0, qd);
+  EXPECT_EQ(0.0, qdd);
+}
+
+TEST(SCurveTrajectoryTest, ShortMoveTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks profiles too short to reach the velocity or acceleration limits, in both "
+    "directions.");
+
+  SCurveTrajectory trajectory;
+
+  // The acceleration limit is reached but not the velocity limit
+  ASSERT_TRUE(trajectory.init(0.0, -3.0, 10.0, 1.0, 2.0));
+  checkTrajectory(trajectory, 10.0, 1.0, 2.0);
+  double qd, qdd;
+  EXPECT_DOUBLE_EQ(-3.0, trajectory.update(trajectory.getDuration(), qd, qdd));
+  trajectory.update(0.5 * trajectory.getDuration(), qd, qdd);
+  EXPECT_LT(qd, 0.0);
+
+  // Neither limit is reached: four jerk segments of (d / (2 j))^(1/3)
+  ASSERT_TRUE(trajectory.init(0.0, 0.002, 10.0, 10.0, 2.0));
+  checkTrajectory(trajectory, 10.0, 10.0, 2.0);
+  EXPECT_NEAR(4.0 * std::cbrt(0.002 / (2.0 * 2.0)), trajectory.getDuration(), 1e-9);
+
+  // No motion
+  ASSERT_TRUE(trajectory.init(2.0, 2.0, 1.0, 1.0, 1.0));
+  EXPECT_EQ(0.0, trajectory.getDuration());
+  EXPECT_DOUBLE_EQ(2.0, trajectory.update(0.5, qd, qdd));
+
+  EXPECT_FALSE(trajectory.init(0.0, 1.0, 0.0, 1.0, 1.0));
+  EXPECT_FALSE(trajectory.scaleToDuration(-1.0));
+}
+
+TEST(SCurveTrajectoryTest, SynchronizedTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that several axes finish together and within their own limits.");
+
+  const std::vector<double> start = {0.0, 1.0, 0.0};
+  const std::vector<double> goal = {10.0, 0.0, 0.0};
+  const std::vector<double> v_max = {2.0, 3.0, 1.0};
+  const std::vector<double> a_max = {1.0, 5.0, 1.0};
+  const std::vector<double> j_max = {1.0, 20.0, 1.0};
+
+  SynchronizedSCurveTrajectory trajectories;
+  ASSERT_TRUE(trajectories.init(start, goal, v_max, a_max, j_max));
+  ASSERT_EQ(3u, trajectories.size());
+
+  SCurveTrajectory slowest;
+  ASSERT_TRUE(slowest.init(0.0, 10.0, 2.0, 1.0, 1.0));
+  EXPECT_DOUBLE_EQ(slowest.getDuration(), trajectories.getDuration());
+
+  std::vector<double> q, qd, qdd;
+  for (double t = 0.0; t < trajectories.getDuration(); t += 1e-3) {
+    trajectories.update(t, q, qd, qdd);
+    for (size_t i = 0; i < start.size(); ++i) {
+      EXPECT_LE(std::abs(qd[i]), v_max[i] + 1e-9);
+      EXPECT_LE(std::abs(qdd[i]), a_max[i] + 1e-9);
+    }
+    // The scaled axis moves during the whole trajectory
+    if (t > 0.0) {
+      EXPECT_LT(qd[1], 0.0);
+    }
+  }
+
+  trajectories.update(trajectories.getDuration(), q, qd, qdd);
+  for (size_t i = 0; i < start.size(); ++i) {
+    EXPECT_DOUBLE_EQ(goal[i], q[i]);
+  }
+
+  EXPECT_FALSE(trajectories.init(start, goal, v_max, a_max, {1.0}));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
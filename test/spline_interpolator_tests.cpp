@@ -0,0 +1,170 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "control_toolbox/spline_interpolator.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::SplineInterpolator;
+
+namespace
+{
+// Feeds a 50 Hz sine to the interpolator and evaluates it at 1 kHz, two periods behind the
+// newest knot
+void upsampleSine(SplineInterpolator & interpolator)
+{
+  const double reference_period = 0.02;
+  const double w = 2.0 * M_PI * 0.5;
+  std::vector<double> q, qd, qdd;
+  int knot = 0;
+  for (int k = 0; k < 4000; ++k) {
+    const double time = k * 1e-3;
+    while (knot * 20 <= k + 40) {
+      const double t = knot * reference_period;
+      EXPECT_TRUE(interpolator.addKnot(t, {std::sin(w * t), 2.0 * std::sin(w * t)}));
+      ++knot;
+    }
+    if (time < reference_period) {
+      continue;
+    }
+    EXPECT_TRUE(interpolator.update(time, q, qd, qdd));
+    EXPECT_NEAR(std::sin(w * time), q[0], 1e-4);
+    EXPECT_NEAR(w * std::cos(w * time), qd[0], 5e-3);
+    EXPECT_DOUBLE_EQ(2.0 * q[0], q[1]);
+  }
+}
+
+// Returns the jumps of the velocity and acceleration across the knots of irregular references
+std::vector<double> jumpsAtKnots(SplineInterpolator::Order order)
+{
+  SplineInterpolator interpolator;
+  EXPECT_TRUE(interpolator.init(1, order, 4));
+  const std::vector<double> times = {0.0, 0.1, 0.25, 0.3, 0.5};
+  const std::vector<double> values = {0.0, 1.0, -0.5, 0.2, 2.0};
+  EXPECT_TRUE(interpolator.addKnot(times[0], {values[0]}));
+  EXPECT_TRUE(interpolator.addKnot(times[1], {values[1]}));
+
+  double velocity_jump = 0.0, acceleration_jump = 0.0;
+  std::vector<double> q, qd, qdd, q_after, qd_after, qdd_after;
+  for (size_t k = 2; k < times.size(); ++k) {
+    EXPECT_TRUE(interpolator.addKnot(times[k], {values[k]}));
+    if (k > 2) {
+      EXPECT_TRUE(interpolator.update(times[k - 2] - 1e-9, q, qd, qdd));
+      EXPECT_TRUE(interpolator.update(times[k - 2] + 1e-9, q_after, qd_after, qdd_after));
+      EXPECT_NEAR(q[0], q_after[0], 1e-6);
+      velocity_jump = std::max(velocity_jump, std::abs(qd[0] - qd_after[0]));
+      acceleration_jump = std::max(acceleration_jump, std::abs(qdd[0] - qdd_after[0]));
+    }
+  }
+  return {velocity_jump, acceleration_jump};
+}
+}  // namespace
+
+TEST(SplineInterpolatorTest, CubicTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that cubic Hermite splines upsample a sine accurately with a continuous "
+    "velocity.");
+
+  SplineInterpolator interpolator;
+  ASSERT_TRUE(interpolator.init(2, SplineInterpolator::Order::CUBIC, 4));
+  upsampleSine(interpolator);
+
+  const std::vector<double> jumps = jumpsAtKnots(SplineInterpolator::Order::CUBIC);
+  EXPECT_LT(jumps[0], 1e-5);
+  EXPECT_GT(jumps[1], 1.0);
+}
+
+TEST(SplineInterpolatorTest, QuinticTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that quintic splines upsample a sine accurately with a continuous "
+    "acceleration.");
+
+  SplineInterpolator interpolator;
+  ASSERT_TRUE(interpolator.init(2, SplineInterpolator::Order::QUINTIC, 4));
+  upsampleSine(interpolator);
+
+  const std::vector<double> jumps = jumpsAtKnots(SplineInterpolator::Order::QUINTIC);
+  EXPECT_LT(jumps[0], 1e-5);
+  EXPECT_LT(jumps[1], 1e-3);
+}
+
+TEST(SplineInterpolatorTest, BufferTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks invalid knots, a full buffer and holding the reference when starved.");
+
+  SplineInterpolator interpolator;
+  EXPECT_FALSE(interpolator.init(1, SplineInterpolator::Order::CUBIC, 2));
+  ASSERT_TRUE(interpolator.init(1, SplineInterpolator::Order::CUBIC, 3));
+
+  std::vector<double> q, qd, qdd;
+  EXPECT_FALSE(interpolator.update(0.0, q, qd, qdd));
+  ASSERT_EQ(1u, q.size());
+
+  EXPECT_TRUE(interpolator.addKnot(0.0, {1.0}));
+  EXPECT_FALSE(interpolator.addKnot(0.0, {2.0}));
+  EXPECT_FALSE(interpolator.addKnot(1.0, {2.0, 3.0}));
+  EXPECT_TRUE(interpolator.addKnot(1.0, {2.0}));
+
+  // The first segment needs the third knot
+  EXPECT_FALSE(interpolator.update(0.5, q, qd, qdd));
+  EXPECT_EQ(1.0, q[0]);
+  EXPECT_TRUE(interpolator.addKnot(2.0, {3.0}));
+  EXPECT_FALSE(interpolator.addKnot(3.0, {4.0}));
+  EXPECT_TRUE(interpolator.update(0.5, q, qd, qdd));
+  EXPECT_DOUBLE_EQ(1.5, q[0]);
+  EXPECT_DOUBLE_EQ(1.0, qd[0]);
+
+  // Past the last segment, the reference is held
+  EXPECT_FALSE(interpolator.update(1.5, q, qd, qdd));
+  EXPECT_EQ(2.0, q[0]);
+  EXPECT_EQ(0.0, qd[0]);
+  EXPECT_EQ(2u, interpolator.getNumKnots());
+  EXPECT_TRUE(interpolator.addKnot(3.0, {4.0}));
+  EXPECT_TRUE(interpolator.update(1.5, q, qd, qdd));
+  EXPECT_DOUBLE_EQ(2.5, q[0]);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
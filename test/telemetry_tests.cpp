@@ -0,0 +1,188 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "control_toolbox/telemetry.hpp"
+
+#include "gtest/gtest.h"
+
+using control_toolbox::TelemetryReader;
+using control_toolbox::TelemetrySample;
+using control_toolbox::TelemetryWriter;
+
+namespace
+{
+std::string uniqueName(const std::string & suffix)
+{
+  // Unique per process, so tests running in parallel do not share rings
+  return "/control_toolbox_test_" + std::to_string(getpid()) + "_" + suffix;
+}
+}  // namespace
+
+TEST(TelemetryTest, RoundTripTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a reader attached to a ring finds the channel names and reads every "
+    "record in order.");
+
+  const std::string name = uniqueName("round_trip");
+  TelemetryWriter writer;
+  ASSERT_TRUE(writer.init(name, {"error", "output"}, 16));
+  EXPECT_EQ(2u, writer.getNumChannels());
+
+  TelemetryReader reader;
+  ASSERT_TRUE(reader.attach(name));
+  ASSERT_EQ(2u, reader.getChannels().size());
+  EXPECT_EQ("error", reader.getChannels()[0]);
+  EXPECT_EQ("output", reader.getChannels()[1]);
+
+  TelemetrySample sample;
+  EXPECT_FALSE(reader.read(sample));
+
+  for (int k = 0; k < 10; ++k) {
+    const double values[2] = {static_cast<double>(k), -2.0 * k};
+    writer.write(1000 * k, values);
+  }
+  for (int k = 0; k < 10; ++k) {
+    ASSERT_TRUE(reader.read(sample));
+    EXPECT_EQ(static_cast<uint64_t>(k), sample.index);
+    EXPECT_EQ(1000 * k, sample.stamp);
+    EXPECT_EQ(static_cast<double>(k), sample.values[0]);
+    EXPECT_EQ(-2.0 * k, sample.values[1]);
+  }
+  EXPECT_FALSE(reader.read(sample));
+  EXPECT_EQ(0u, reader.getNumDropped());
+}
+
+TEST(TelemetryTest, OverrunTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a slow reader skips the overwritten records and counts them.");
+
+  const std::string name = uniqueName("overrun");
+  TelemetryWriter writer;
+  ASSERT_TRUE(writer.init(name, {"value"}, 8));
+  TelemetryReader reader;
+  ASSERT_TRUE(reader.attach(name));
+
+  for (int k = 0; k < 20; ++k) {
+    const double value = k;
+    writer.write(k, &value);
+  }
+
+  TelemetrySample sample;
+  ASSERT_TRUE(reader.read(sample));
+  EXPECT_EQ(12u, sample.index);
+  EXPECT_EQ(12.0, sample.values[0]);
+  EXPECT_EQ(12u, reader.getNumDropped());
+
+  int count = 1;
+  while (reader.read(sample)) {
+    ++count;
+  }
+  EXPECT_EQ(8, count);
+  EXPECT_EQ(19.0, sample.values[0]);
+}
+
+TEST(TelemetryTest, BadInputTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that invalid channels are rejected and that readers cannot attach to a "
+    "missing or closed ring.");
+
+  const std::string name = uniqueName("bad_input");
+  TelemetryWriter writer;
+  EXPECT_FALSE(writer.init(name, {}, 8));
+  EXPECT_FALSE(writer.init(name, {"value"}, 0));
+  EXPECT_FALSE(writer.init(name, {std::string(TelemetryWriter::MAX_NAME_LENGTH + 1, 'x')}, 8));
+  EXPECT_EQ(0u, writer.getNumChannels());
+
+  TelemetryReader reader;
+  EXPECT_FALSE(reader.attach(name));
+  ASSERT_TRUE(writer.init(name, {"value"}, 8));
+  EXPECT_TRUE(reader.attach(name));
+  writer.close();
+  reader.detach();
+  EXPECT_FALSE(reader.attach(name));
+}
+
+TEST(TelemetryTest, ReplaceTest)
+{
+  RecordProperty(
+    "description",
+    "This test checks that a ring created with the name of a live one leaves the old writer "
+    "intact, and that closing the old writer does not remove the new ring.");
+
+  const std::string name = uniqueName("replace");
+  auto old_writer = std::make_unique<TelemetryWriter>();
+  ASSERT_TRUE(old_writer->init(name, {"value"}, 8));
+  TelemetryReader old_reader;
+  ASSERT_TRUE(old_reader.attach(name));
+
+  TelemetryWriter writer;
+  ASSERT_TRUE(writer.init(name, {"first", "second"}, 8));
+
+  // The old writer keeps its own ring, the new ring does not see its records
+  const double value = 1.0;
+  old_writer->write(1, &value);
+  TelemetrySample sample;
+  ASSERT_TRUE(old_reader.read(sample));
+  EXPECT_EQ(1.0, sample.values[0]);
+  old_writer.reset();
+
+  TelemetryReader reader;
+  ASSERT_TRUE(reader.attach(name));
+  ASSERT_EQ(2u, reader.getChannels().size());
+  EXPECT_FALSE(reader.read(sample));
+  const double values[2] = {2.0, 3.0};
+  writer.write(2, values);
+  ASSERT_TRUE(reader.read(sample));
+  EXPECT_EQ(3.0, sample.values[1]);
+
+  writer.close();
+  reader.detach();
+  EXPECT_FALSE(reader.attach(name));
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
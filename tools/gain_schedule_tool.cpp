@@ -0,0 +1,179 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Writes a gain schedule file from text tables, or checks an existing one.
+//
+// usage: gain_schedule_tool [--gains FILE] [--proxy FILE] --output FILE
+//        gain_schedule_tool --check FILE
+//
+// The tables have one breakpoint per line, values separated by commas or
+// spaces, lines starting with '#' are ignored:
+//   gains: breakpoint p i d i_max i_min antiwindup
+//   proxy: breakpoint mass Kd Kp Ki Ficl effort_limit vel_limit pos_upper_limit
+//          pos_lower_limit lambda_proxy acc_converge
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "control_toolbox/gain_schedule.hpp"
+
+using control_toolbox::GainSchedule;
+using control_toolbox::LimitedProxyParameters;
+using control_toolbox::Pid;
+
+namespace
+{
+// Reads the rows of a table, each with the given number of values
+bool readTable(
+  const std::string & path, std::size_t columns, std::vector<std::vector<double>> & rows)
+{
+  std::ifstream file(path);
+  if (!file) {
+    std::fprintf(stderr, "Could not open %s.\n", path.c_str());
+    return false;
+  }
+  std::string line;
+  for (std::size_t number = 1; std::getline(file, line); ++number) {
+    const auto first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+    for (auto & c : line) {
+      c = c == ',' ? ' ' : c;
+    }
+    std::istringstream stream(line);
+    std::vector<double> row;
+    double value;
+    while (stream >> value) {
+      row.push_back(value);
+    }
+    if (!stream.eof() || row.size() != columns) {
+      std::fprintf(
+        stderr, "%s:%zu: expected %zu numbers per line.\n", path.c_str(), number, columns);
+      return false;
+    }
+    rows.push_back(row);
+  }
+  return true;
+}
+
+int check(const std::string & path)
+{
+  const auto start = std::chrono::steady_clock::now();
+  std::shared_ptr<const GainSchedule> schedule = GainSchedule::load(path);
+  const double elapsed =
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (!schedule) {
+    return EXIT_FAILURE;
+  }
+  std::printf(
+    "%s: %zu gain breakpoints, %zu proxy breakpoints, loaded in %.3f ms\n", path.c_str(),
+    schedule->getNumGains(), schedule->getNumProxyParameters(), elapsed);
+  return EXIT_SUCCESS;
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  std::string gains_path, proxy_path, output_path;
+  for (int k = 1; k + 1 < argc; k += 2) {
+    const std::string option = argv[k];
+    if (option == "--check") {
+      return check(argv[k + 1]);
+    } else if (option == "--gains") {
+      gains_path = argv[k + 1];
+    } else if (option == "--proxy") {
+      proxy_path = argv[k + 1];
+    } else if (option == "--output") {
+      output_path = argv[k + 1];
+    } else {
+      output_path.clear();
+      break;
+    }
+  }
+  if (output_path.empty() || (gains_path.empty() && proxy_path.empty())) {
+    std::fprintf(
+      stderr,
+      "usage: %s [--gains FILE] [--proxy FILE] --output FILE\n"
+      "       %s --check FILE\n",
+      argv[0], argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::vector<double>> rows;
+  std::vector<double> gain_breakpoints, proxy_breakpoints;
+  std::vector<Pid::Gains> gains;
+  std::vector<LimitedProxyParameters> proxy_parameters;
+  if (!gains_path.empty()) {
+    if (!readTable(gains_path, 7, rows)) {
+      return EXIT_FAILURE;
+    }
+    for (const auto & r : rows) {
+      gain_breakpoints.push_back(r[0]);
+      gains.emplace_back(r[1], r[2], r[3], r[4], r[5], r[6] != 0.0);
+    }
+  }
+  rows.clear();
+  if (!proxy_path.empty()) {
+    if (!readTable(proxy_path, 12, rows)) {
+      return EXIT_FAILURE;
+    }
+    for (const auto & r : rows) {
+      proxy_breakpoints.push_back(r[0]);
+      LimitedProxyParameters p;
+      p.mass = r[1];
+      p.Kd = r[2];
+      p.Kp = r[3];
+      p.Ki = r[4];
+      p.Ficl = r[5];
+      p.effort_limit = r[6];
+      p.vel_limit = r[7];
+      p.pos_upper_limit = r[8];
+      p.pos_lower_limit = r[9];
+      p.lambda_proxy = r[10];
+      p.acc_converge = r[11];
+      proxy_parameters.push_back(p);
+    }
+  }
+
+  if (!GainSchedule::write(
+        output_path, gain_breakpoints, gains, proxy_breakpoints, proxy_parameters)) {
+    return EXIT_FAILURE;
+  }
+  return check(output_path);
+}
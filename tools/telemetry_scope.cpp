@@ -0,0 +1,127 @@
+// Copyright (c) 2023, Open Source Robotics Foundation, Inc.
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//  * Neither the name of the Willow Garage nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// Prints the channels of a telemetry ring in the terminal.
+//
+// usage: telemetry_scope <name> [rate_hz]
+//
+// Every refresh shows, for each channel, the last value and the minimum and
+// maximum over the records written since the previous refresh, as well as the
+// record rate and the number of records lost because the scope fell behind.
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "control_toolbox/telemetry.hpp"
+
+namespace
+{
+volatile std::sig_atomic_t running = 1;
+
+void stop(int) { running = 0; }
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <name> [rate_hz]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  const double rate = argc > 2 ? std::atof(argv[2]) : 10.0;
+  if (!(rate > 0.0)) {
+    std::fprintf(stderr, "The refresh rate must be positive.\n");
+    return EXIT_FAILURE;
+  }
+
+  control_toolbox::TelemetryReader reader;
+  if (!reader.attach(argv[1])) {
+    return EXIT_FAILURE;
+  }
+  std::signal(SIGINT, stop);
+  std::signal(SIGTERM, stop);
+
+  const auto & channels = reader.getChannels();
+  const std::size_t n = channels.size();
+  std::size_t width = 0;
+  for (const auto & channel : channels) {
+    width = std::max(width, channel.size());
+  }
+
+  control_toolbox::TelemetrySample sample;
+  std::vector<double> last(n, 0.0), minimum(n), maximum(n);
+  const auto period = std::chrono::duration<double>(1.0 / rate);
+  auto next = std::chrono::steady_clock::now();
+
+  while (running) {
+    std::fill(minimum.begin(), minimum.end(), std::numeric_limits<double>::infinity());
+    std::fill(maximum.begin(), maximum.end(), -std::numeric_limits<double>::infinity());
+    std::size_t count = 0;
+    while (reader.read(sample)) {
+      for (std::size_t k = 0; k < n; ++k) {
+        last[k] = sample.values[k];
+        minimum[k] = std::min(minimum[k], last[k]);
+        maximum[k] = std::max(maximum[k], last[k]);
+      }
+      ++count;
+    }
+
+    // Clear the terminal and redraw from the top left corner
+    std::printf(
+      "\033[2J\033[H%s: %.0f records/s, %llu lost\n\n", argv[1], count * rate,
+      static_cast<unsigned long long>(reader.getNumDropped()));
+    std::printf(
+      "%-*s %14s %14s %14s\n", static_cast<int>(width), "channel", "last", "min", "max");
+    for (std::size_t k = 0; k < n; ++k) {
+      if (count > 0) {
+        std::printf(
+          "%-*s %14.6g %14.6g %14.6g\n", static_cast<int>(width), channels[k].c_str(), last[k],
+          minimum[k], maximum[k]);
+      } else {
+        std::printf(
+          "%-*s %14.6g %14s %14s\n", static_cast<int>(width), channels[k].c_str(), last[k], "-",
+          "-");
+      }
+    }
+    std::fflush(stdout);
+
+    next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+    std::this_thread::sleep_until(next);
+  }
+  return EXIT_SUCCESS;
+}